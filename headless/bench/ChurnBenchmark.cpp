@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Goes through the hot paths of the history the way MainWindow does and
+ * reports the allocations and copies of each: loading the journal,
+ * clipboard changes (saving the journal nested within), and typing into
+ * the filter. Built with CLIPDINGER_INSTRUMENT, see Instrumentation.h.
+ * Diff the reports of two revisions to spot churn regressions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+#include <vector>
+
+#include "ClipBuffer.h"
+#include "ClipFilter.h"
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FileWriter.h"
+#include "HistoryJournal.h"
+#include "Instrumentation.h"
+
+
+static const char* kQueries[] = { "error", "https", "function", "zzz" };
+
+
+int
+main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : "churn_benchmark.journal";
+	int32 count = argc > 2 ? atoi(argv[2]) : 1000;
+	const char* output = argc > 3 ? argv[3] : NULL;
+
+	if (!instrument_enabled()) {
+		fprintf(stderr, "Build with CLIPDINGER_INSTRUMENT to count.\n");
+		return 1;
+	}
+
+	// A history to start from, not counted
+	Corpus corpus;
+	remove(path);
+	{
+		FileWriter writer;
+		ClipStore store(count);
+		HistoryJournal journal(writer);
+		journal.Create(path, store);
+		for (int32 i = 0; i < count; i++)
+			store.AddClip(corpus.NextClip(CORPUS_MIXED), "", "", i, i);
+		journal.Close(count);
+	}
+	instrument_reset();
+
+	FileWriter writer;
+	ClipStore store(count);
+	HistoryJournal journal(writer);
+	{
+		INSTRUMENT_SCOPE("load_history");
+		bigtime_t quitTime;
+		if (journal.Open(path, store, &quitTime) != B_OK) {
+			fprintf(stderr, "Couldn't open %s.\n", path);
+			return 1;
+		}
+	}
+
+	std::vector<std::string> clips;
+	corpus.Generate(count / 10, CORPUS_MIXED, clips);
+	for (size_t i = 0; i < clips.size(); i++) {
+		INSTRUMENT_SCOPE("clipboard_changed");
+		ClipBufferRef clip = ClipBuffer::Create(clips[i].data(),
+			clips[i].length());
+		store.MakeUnique(*clip);
+		store.AddClip(clip, "", "/boot/system/apps/Terminal", count + i,
+			count + i);
+	}
+
+	ClipFilter filter(store);
+	for (size_t i = 0; i < sizeof(kQueries) / sizeof(kQueries[0]); i++) {
+		std::string query;
+		for (const char* c = kQueries[i]; *c != '\0'; c++) {
+			query += *c;
+			INSTRUMENT_SCOPE("filter_input");
+			filter.SetQuery(query.c_str());
+		}
+		filter.Reset();
+	}
+
+	journal.Close(2 * count);
+	writer.Flush();
+	remove(path);
+
+	if (output != NULL) {
+		if (instrument_dump(output) != B_OK) {
+			fprintf(stderr, "Couldn't write %s.\n", output);
+			return 1;
+		}
+	} else
+		fputs(instrument_report().c_str(), stdout);
+	return 0;
+}
@@ -0,0 +1,513 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Microbenchmarks of the history and favorites core, for histories of 100
+ * to 1M clips with short, medium and huge clips. Every operation is timed
+ * on its own and the percentiles are printed as CSV, one line per
+ * benchmark, clip count and distribution:
+ *
+ *	benchmark,clips,distribution,samples,p50_us,p90_us,p99_us,max_us
+ *
+ * Cases that would need more memory than allowed are skipped with a note
+ * on stderr. The history is benchmarked without a blob store, so huge
+ * clips stay in the journal.
+ *
+ * The favorites live in a BListView in the GUI, they're modelled here the
+ * way MainWindow and FavView treat them: a duplicate check against every
+ * favorite when adding, swapping neighbours to reorder, renumbering the
+ * F-keys and writing all favorites as records after each change.
+ *
+ * Usage: core_benchmark [-c counts] [-d distributions] [-m memory MB]
+ *	[-j journal path] [-t trace path]
+ * with comma separated lists, e.g. "-c 100,10000 -d short,medium". Built
+ * with "make TRACE=1", -t writes the spans of the core as a Chrome trace,
+ * see Tracing.h.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ClipBuffer.h"
+#include "ClipFilter.h"
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FileWriter.h"
+#include "HistoryJournal.h"
+#include "RecordFile.h"
+#include "Tracing.h"
+
+
+static const int32 kDefaultCounts[] = { 100, 10000, 100000, 1000000 };
+static const int32 kDefaultDistributions[]
+	= { CORPUS_SHORT, CORPUS_MEDIUM, CORPUS_HUGE };
+static const size_t kQueryLengths[] = { 1, 2, 4, 8, 16 };
+
+// Rough average clip sizes of the Corpus, to skip what doesn't fit
+static const double kAverageBytes[] = { 100, 3200, 1.3 * 1024 * 1024 };
+
+static const uint32 kFavoriteRecord = 'FAVR';
+
+
+typedef std::chrono::steady_clock bench_clock;
+
+
+class Timings {
+public:
+	void				Start() { fStart = bench_clock::now(); }
+	void				Stop()
+	{
+		fSamples.push_back(std::chrono::duration<double, std::micro>(
+			bench_clock::now() - fStart).count());
+	}
+
+	void				Print(const char* benchmark, int32 clips,
+							int32 distribution);
+
+private:
+	double				_Percentile(double percent) const;
+
+	bench_clock::time_point fStart;
+	std::vector<double>	fSamples;
+};
+
+
+void
+Timings::Print(const char* benchmark, int32 clips, int32 distribution)
+{
+	if (fSamples.empty())
+		return;
+
+	std::sort(fSamples.begin(), fSamples.end());
+	printf("%s,%d,%s,%zu,%.3f,%.3f,%.3f,%.3f\n", benchmark, clips,
+		Corpus::DistributionName(distribution), fSamples.size(),
+		_Percentile(50), _Percentile(90), _Percentile(99), fSamples.back());
+	fflush(stdout);
+}
+
+
+double
+Timings::_Percentile(double percent) const
+{
+	size_t index = (size_t)(percent / 100 * (fSamples.size() - 1) + 0.5);
+	return fSamples[index];
+}
+
+
+struct favorite {
+	std::string			clip;
+	std::string			title;
+	int32				number;
+};
+
+
+struct bench_context {
+	int32				clips;
+	int32				distribution;
+	const char*			journal;
+	std::mt19937		random;
+
+	// Number of samples for cheap operations and for ones that go
+	// through all clips
+	int32				Samples() const
+	{
+		return std::max(10, std::min(1000, 10000000 / clips));
+	}
+	int32				HeavySamples(uint64 bytes) const
+	{
+		return (int32)std::max<uint64>(3,
+			std::min<uint64>(20, (256 << 20) / (bytes + 1)));
+	}
+	int32				Index(int32 count)
+	{
+		return std::uniform_int_distribution<int32>(0, count - 1)(random);
+	}
+};
+
+
+static void
+parse_list(const char* list, std::vector<std::string>& items)
+{
+	items.clear();
+	const char* start = list;
+	while (true) {
+		const char* end = strchr(start, ',');
+		if (end == NULL) {
+			items.push_back(start);
+			break;
+		}
+		items.push_back(std::string(start, end - start));
+		start = end + 1;
+	}
+}
+
+
+static int32
+distribution_for(const std::string& name)
+{
+	for (int32 i = CORPUS_SHORT; i <= CORPUS_MIXED; i++) {
+		if (name == Corpus::DistributionName(i))
+			return i;
+	}
+	return -1;
+}
+
+
+// #pragma mark - History
+
+
+static void
+bench_add(bench_context& context, ClipStore& store, Corpus& corpus)
+{
+	Timings timings;
+	for (int32 i = 0; i < context.clips; i++) {
+		std::string text = corpus.NextClip(context.distribution);
+
+		timings.Start();
+		ClipBufferRef clip = ClipBuffer::Create(text.data(), text.length());
+		store.MakeUnique(*clip);
+		store.AddClip(clip, "", "/boot/system/apps/Terminal", i, i);
+		timings.Stop();
+	}
+	timings.Print("add", context.clips, context.distribution);
+}
+
+
+static void
+bench_add_duplicate(bench_context& context, ClipStore& store)
+{
+	Timings timings;
+	int32 samples = context.Samples();
+	for (int32 i = 0; i < samples; i++) {
+		ClipRecord* record = store.ClipAt(context.Index(store.CountClips()));
+		std::string text(record->GetClipData(), record->GetClipLength());
+
+		timings.Start();
+		ClipBufferRef clip = ClipBuffer::Create(text.data(), text.length());
+		store.MakeUnique(*clip);
+		store.AddClip(clip, "", "/boot/system/apps/Terminal",
+			context.clips + i, context.clips + i);
+		timings.Stop();
+	}
+	timings.Print("add_duplicate", context.clips, context.distribution);
+}
+
+
+static void
+bench_move_to_top(bench_context& context, ClipStore& store)
+{
+	Timings timings;
+	int32 samples = context.Samples();
+	for (int32 i = 0; i < samples; i++) {
+		int32 index = context.Index(store.CountClips());
+
+		timings.Start();
+		store.MoveToTop(index, 2 * context.clips + i);
+		timings.Stop();
+	}
+	timings.Print("move_to_top", context.clips, context.distribution);
+}
+
+
+static void
+bench_filter(bench_context& context, ClipStore& store)
+{
+	ClipFilter filter(store);
+	int32 samples = std::max(10, context.Samples() / 10);
+
+	for (size_t i = 0; i < sizeof(kQueryLengths) / sizeof(kQueryLengths[0]);
+			i++) {
+		size_t length = kQueryLengths[i];
+		Timings timings;
+		for (int32 j = 0; j < samples; j++) {
+			// A piece of some clip, so there's at least one match
+			std::string query;
+			for (int32 tries = 0; tries < 10 && query.empty(); tries++) {
+				ClipRecord* record
+					= store.ClipAt(context.Index(store.CountClips()));
+				size_t clipLength = record->GetClipLength();
+				if (clipLength < length)
+					continue;
+				size_t offset = context.Index(clipLength - length + 1);
+				query.assign(record->GetClipData() + offset, length);
+				if (query.find('\0') != std::string::npos)
+					query.clear();
+			}
+			if (query.empty())
+				continue;
+			filter.Reset();
+
+			timings.Start();
+			filter.SetQuery(query.c_str());
+			timings.Stop();
+		}
+
+		char name[32];
+		snprintf(name, sizeof(name), "filter_%zu", length);
+		timings.Print(name, context.clips, context.distribution);
+	}
+}
+
+
+static void
+bench_save(bench_context& context, ClipStore& store)
+{
+	Timings timings;
+	int32 samples = context.HeavySamples(store.CountBytes());
+	for (int32 i = 0; i < samples; i++) {
+		FileWriter writer;
+		HistoryJournal journal(writer);
+
+		timings.Start();
+		journal.Create(context.journal, store);
+		writer.Flush();
+		timings.Stop();
+	}
+	timings.Print("save", context.clips, context.distribution);
+
+	std::string indexPath(context.journal);
+	indexPath += ".index";
+	store.SaveIndex(indexPath.c_str());
+}
+
+
+static void
+bench_load(bench_context& context, uint64 bytes)
+{
+	std::string indexPath(context.journal);
+	indexPath += ".index";
+
+	Timings timings;
+	int32 samples = context.HeavySamples(bytes);
+	for (int32 i = 0; i < samples; i++) {
+		FileWriter writer;
+		HistoryJournal journal(writer);
+		ClipStore store(context.clips);
+
+		// Like MainWindow::_LoadHistory()
+		timings.Start();
+		store.SuspendIndex();
+		bigtime_t quitTime;
+		journal.Open(context.journal, store, &quitTime);
+		store.LoadIndex(indexPath.c_str());
+		timings.Stop();
+	}
+	timings.Print("load", context.clips, context.distribution);
+
+	remove(indexPath.c_str());
+}
+
+
+static void
+bench_crop(bench_context& context, ClipStore& store)
+{
+	Timings timings;
+	int32 samples = std::min(context.Samples(), store.CountClips() - 1);
+	for (int32 i = 0; i < samples; i++) {
+		timings.Start();
+		store.Crop(store.CountClips() - 1);
+		timings.Stop();
+	}
+	timings.Print("crop", context.clips, context.distribution);
+}
+
+
+// #pragma mark - Favorites
+
+
+static void
+renumber_favorites(std::vector<favorite>& favorites)
+{
+	for (size_t i = 0; i < favorites.size(); i++)
+		favorites[i].number = i;
+}
+
+
+static void
+save_favorites(const std::vector<favorite>& favorites, std::string& data)
+{
+	data.clear();
+	RecordWriter writer(data);
+	for (size_t i = 0; i < favorites.size(); i++) {
+		writer.StartRecord(kFavoriteRecord);
+		writer.PutString(favorites[i].clip);
+		writer.PutString(favorites[i].title);
+		writer.EndRecord();
+	}
+}
+
+
+static void
+bench_favorites(bench_context& context, const ClipStore& store)
+{
+	std::vector<favorite> favorites;
+	favorites.reserve(store.CountClips() + context.Samples());
+	// All but a few, those get added
+	int32 samples = std::min(context.Samples(), store.CountClips());
+	int32 count = store.CountClips() - samples;
+	for (int32 i = 0; i < count; i++) {
+		ClipRecord* record = store.ClipAt(i);
+		favorite entry = { std::string(record->GetClipData(),
+			record->GetClipLength()), "", i };
+		favorites.push_back(entry);
+	}
+
+	// The whole list gets written after each change
+	std::string data;
+	Timings add;
+	samples = std::min(samples,
+		context.HeavySamples(store.CountBytes()) * 10);
+	for (int32 i = 0; i < samples; i++) {
+		ClipRecord* record = store.ClipAt(count + i);
+		favorite entry = { std::string(record->GetClipData(),
+			record->GetClipLength()), "", 0 };
+
+		add.Start();
+		bool duplicate = false;
+		for (size_t j = 0; j < favorites.size() && !duplicate; j++)
+			duplicate = favorites[j].clip == entry.clip;
+		if (!duplicate) {
+			favorites.push_back(entry);
+			renumber_favorites(favorites);
+			save_favorites(favorites, data);
+		}
+		add.Stop();
+	}
+	add.Print("favorite_add", context.clips, context.distribution);
+
+	Timings reorder;
+	for (int32 i = 0; i < samples; i++) {
+		int32 index = context.Index(favorites.size() - 1);
+
+		reorder.Start();
+		std::swap(favorites[index], favorites[index + 1]);
+		renumber_favorites(favorites);
+		save_favorites(favorites, data);
+		reorder.Stop();
+	}
+	reorder.Print("favorite_reorder", context.clips, context.distribution);
+
+	Timings renumber;
+	for (int32 i = 0; i < context.Samples(); i++) {
+		renumber.Start();
+		renumber_favorites(favorites);
+		renumber.Stop();
+	}
+	renumber.Print("favorite_renumber", context.clips, context.distribution);
+}
+
+
+static void
+run(bench_context& context)
+{
+	Corpus corpus(context.clips);
+	ClipStore store(context.clips);
+
+	bench_add(context, store, corpus);
+	bench_add_duplicate(context, store);
+	bench_move_to_top(context, store);
+	bench_filter(context, store);
+	bench_favorites(context, store);
+	bench_save(context, store);
+	bench_load(context, store.CountBytes());
+	bench_crop(context, store);
+
+	remove(context.journal);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	std::vector<int32> counts(kDefaultCounts, kDefaultCounts
+		+ sizeof(kDefaultCounts) / sizeof(kDefaultCounts[0]));
+	std::vector<int32> distributions(kDefaultDistributions,
+		kDefaultDistributions
+			+ sizeof(kDefaultDistributions) / sizeof(kDefaultDistributions[0]));
+	double memory = 1024;
+	const char* journal = "core_benchmark.journal";
+	const char* trace = NULL;
+
+	int option;
+	std::vector<std::string> items;
+	while ((option = getopt(argc, argv, "c:d:m:j:t:")) != -1) {
+		switch (option) {
+			case 'c':
+				parse_list(optarg, items);
+				counts.clear();
+				for (size_t i = 0; i < items.size(); i++)
+					counts.push_back(atoi(items[i].c_str()));
+				break;
+			case 'd':
+				parse_list(optarg, items);
+				distributions.clear();
+				for (size_t i = 0; i < items.size(); i++) {
+					int32 distribution = distribution_for(items[i]);
+					if (distribution < CORPUS_SHORT
+						|| distribution > CORPUS_HUGE) {
+						fprintf(stderr, "Unknown distribution '%s'.\n",
+							items[i].c_str());
+						return 1;
+					}
+					distributions.push_back(distribution);
+				}
+				break;
+			case 'm':
+				memory = atof(optarg);
+				break;
+			case 'j':
+				journal = optarg;
+				break;
+			case 't':
+				trace = optarg;
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-c counts] [-d distributions] "
+					"[-m memory MB] [-j journal path] [-t trace path]\n",
+					argv[0]);
+				return 1;
+		}
+	}
+
+	printf("benchmark,clips,distribution,samples,p50_us,p90_us,p99_us,"
+		"max_us\n");
+
+	for (size_t i = 0; i < distributions.size(); i++) {
+		for (size_t j = 0; j < counts.size(); j++) {
+			if (counts[j] < 2)
+				continue;
+
+			// The clips, and a copy as favorites
+			double needed = 2 * counts[j] * kAverageBytes[distributions[i]]
+				/ (1024 * 1024);
+			if (needed > memory) {
+				fprintf(stderr, "Skipping %d %s clips, they'd need about "
+					"%.0f MB (-m).\n", counts[j],
+					Corpus::DistributionName(distributions[i]), needed);
+				continue;
+			}
+
+			bench_context context = { counts[j], distributions[i], journal,
+				std::mt19937(counts[j]) };
+			run(context);
+		}
+	}
+
+	if (trace != NULL) {
+		if (!trace_enabled())
+			fprintf(stderr, "No spans, build with TRACE=1 for a trace.\n");
+		else if (trace_dump(trace) != B_OK) {
+			fprintf(stderr, "Couldn't write the trace to %s.\n", trace);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <stdio.h>
+
+#include "Corpus.h"
+
+
+static const char* kWords[] = {
+	"the", "clipboard", "history", "of", "and", "to", "a", "Haiku", "window",
+	"paste", "favorite", "filter", "is", "in", "that", "with", "for", "it",
+	"Straße", "Größe", "über", "déjà", "café", "naïve", "Ärger", "Öl",
+	"привет", "мир", "Буфер", "обмена", "данные", "ΑΘΗΝΑ", "σοφία", "λόγος",
+	"日本語", "テキスト", "文字", "señor", "niño", "ÉCOLE", "Français",
+	"error", "warning", "Settings", "deskbar", "replicant", "tracker"
+};
+static const size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+static const char* kCode[] = {
+	"void\nMainWindow::MessageReceived(BMessage* message)\n{\n",
+	"\tswitch (message->what) {\n", "\t\tcase B_CLIPBOARD_CHANGED:\n",
+	"\tfor (int32 i = 0; i < CountItems(); i++) {\n", "\t\treturn B_OK;\n",
+	"#include <String.h>\n", "\tBString text(item->GetClip());\n",
+	"std::vector<int32> matches;\n", "if (status != B_OK)\n\treturn status;\n",
+	"}\n\n", "// TODO: handle the error\n", "const char* kName = \"value\";\n"
+};
+static const size_t kCodeCount = sizeof(kCode) / sizeof(kCode[0]);
+
+static const char kBase64[]
+	= "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+
+Corpus::Corpus(uint32 seed)
+	:
+	fState(seed * 0x9E3779B97F4A7C15ULL + 1),
+	fCounter(0)
+{
+}
+
+
+std::string
+Corpus::NextClip(int32 distribution)
+{
+	if (distribution == CORPUS_MIXED) {
+		uint32 dice = _Random(1000);
+		if (dice < 800)
+			distribution = CORPUS_SHORT;
+		else if (dice < 995)
+			distribution = CORPUS_MEDIUM;
+		else
+			distribution = CORPUS_HUGE;
+	}
+
+	std::string clip;
+	// Makes every clip unique, like the history is
+	char serial[32];
+	snprintf(serial, sizeof(serial), "#%llu ", (unsigned long long)fCounter++);
+
+	switch (distribution) {
+		case CORPUS_SHORT:
+		{
+			uint32 kind = _Random(4);
+			if (kind == 0) {
+				clip = "https://www.haiku-os.org/docs/";
+				clip += kWords[_Random(kWordCount)];
+				clip += "?id=";
+			} else
+				_AppendText(clip, 8 + _Random(120));
+			clip += serial;
+			break;
+		}
+		case CORPUS_MEDIUM:
+		{
+			clip = serial;
+			if (_Random(2) == 0)
+				_AppendText(clip, 200 + _Random(4000));
+			else
+				_AppendCode(clip, 200 + _Random(8000));
+			break;
+		}
+		case CORPUS_HUGE:
+		{
+			clip = serial;
+			if (_Random(2) == 0)
+				_AppendLog(clip, 256 * 1024 + _Random(2 * 1024 * 1024));
+			else
+				_AppendBase64(clip, 256 * 1024 + _Random(2 * 1024 * 1024));
+			break;
+		}
+	}
+	return clip;
+}
+
+
+void
+Corpus::Generate(int32 count, int32 distribution, std::vector<std::string>& clips)
+{
+	clips.clear();
+	clips.reserve(count);
+	for (int32 i = 0; i < count; i++)
+		clips.push_back(NextClip(distribution));
+}
+
+
+const char*
+Corpus::DistributionName(int32 distribution)
+{
+	switch (distribution) {
+		case CORPUS_SHORT:
+			return "short";
+		case CORPUS_MEDIUM:
+			return "medium";
+		case CORPUS_HUGE:
+			return "huge";
+		default:
+			return "mixed";
+	}
+}
+
+
+uint32
+Corpus::_Random()
+{
+	// xorshift64*
+	fState ^= fState >> 12;
+	fState ^= fState << 25;
+	fState ^= fState >> 27;
+	return (fState * 0x2545F4914F6CDD1DULL) >> 32;
+}
+
+
+void
+Corpus::_AppendText(std::string& clip, size_t length)
+{
+	size_t end = clip.length() + length;
+	while (clip.length() < end) {
+		clip += kWords[_Random(kWordCount)];
+		clip += _Random(12) == 0 ? ".\n" : " ";
+	}
+}
+
+
+void
+Corpus::_AppendCode(std::string& clip, size_t length)
+{
+	size_t end = clip.length() + length;
+	while (clip.length() < end)
+		clip += kCode[_Random(kCodeCount)];
+}
+
+
+void
+Corpus::_AppendLog(std::string& clip, size_t length)
+{
+	size_t end = clip.length() + length;
+	char line[160];
+	while (clip.length() < end) {
+		snprintf(line, sizeof(line), "KERN: [%5u.%03u] %s: %s %s %u\n",
+			_Random(100000), _Random(1000), kWords[_Random(kWordCount)],
+			kWords[_Random(kWordCount)], kWords[_Random(kWordCount)],
+			_Random(65536));
+		clip += line;
+	}
+}
+
+
+void
+Corpus::_AppendBase64(std::string& clip, size_t length)
+{
+	size_t end = clip.length() + length;
+	clip.reserve(end);
+	while (clip.length() < end) {
+		for (int32 i = 0; i < 76; i++)
+			clip += kBase64[_Random(64)];
+		clip += '\n';
+	}
+}
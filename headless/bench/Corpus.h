@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Synthetic but realistic clip bodies for the benchmarks: prose in a few
+ * languages, source code, URLs, log dumps and base64 blobs.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <string>
+#include <vector>
+
+#include "CoreDefs.h"
+
+
+enum {
+	CORPUS_SHORT = 0,	// words, URLs, one-liners
+	CORPUS_MEDIUM,		// paragraphs and code snippets, up to a few KB
+	CORPUS_HUGE,		// log dumps and base64 blobs, up to a few MB
+	CORPUS_MIXED		// mostly short, some medium, few huge
+};
+
+
+class Corpus {
+public:
+						Corpus(uint32 seed = 1);
+
+	std::string			NextClip(int32 distribution);
+	void				Generate(int32 count, int32 distribution,
+							std::vector<std::string>& clips);
+
+	static const char*	DistributionName(int32 distribution);
+
+private:
+	uint32				_Random();
+	uint32				_Random(uint32 limit) { return _Random() % limit; }
+	void				_AppendText(std::string& clip, size_t length);
+	void				_AppendCode(std::string& clip, size_t length);
+	void				_AppendLog(std::string& clip, size_t length);
+	void				_AppendBase64(std::string& clip, size_t length);
+
+	uint64				fState;
+	uint64				fCounter;
+};
+
+#endif // CORPUS_H
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * What filtering costs the window thread. Types a query one character at
+ * a time and compares how long ClipFilter::SetQuery() blocks with how
+ * long FilterWorker::Start() does, when the first partial matches arrive
+ * and when the query is done. Then cancels queries in flight, the way a
+ * keystroke does, and measures how long Cancel() waits for the worker.
+ * With a single CPU, the time Start() blocks includes the worker taking
+ * over; the window thread's higher priority prevents that on Haiku.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ClipFilter.h"
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FilterWorker.h"
+#include "FuzzyMatcher.h"
+
+
+static const int32 kCancels = 50;
+static const int32 kFuzzyResults = 500;
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Stands in for the window's message queue
+class found_queue {
+public:
+						found_queue()
+							:
+							fGeneration(0),
+							fPosted(false)
+						{
+						}
+
+	void				Post(uint32 generation)
+						{
+							std::lock_guard<std::mutex> lock(fLock);
+							fGeneration = generation;
+							fPosted = true;
+							fCondition.notify_all();
+						}
+
+	uint32				Wait()
+						{
+							std::unique_lock<std::mutex> lock(fLock);
+							while (!fPosted)
+								fCondition.wait(lock);
+							fPosted = false;
+							return fGeneration;
+						}
+
+private:
+	std::mutex			fLock;
+	std::condition_variable fCondition;
+	uint32				fGeneration;
+	bool				fPosted;
+};
+
+
+static void
+type_query(const ClipStore& store, const char* query, bool fuzzy)
+{
+	ClipFilter filter(store);
+	FilterWorker worker(store);
+	found_queue queue;
+	worker.SetFoundFunction([&queue](uint32 generation, bigtime_t) {
+		queue.Post(generation);
+		return true;
+	});
+
+	printf("%-20s %8s %10s %10s %10s %10s\n", "query", "matches",
+		fuzzy ? "rank ms" : "sync ms", "block us", "first ms", "done ms");
+
+	std::vector<FuzzyResult> results;
+	std::vector<int32> matches;
+	std::string typed;
+	for (size_t i = 0; i < strlen(query); i++) {
+		typed += query[i];
+
+		double start = now();
+		if (fuzzy)
+			rank_clips(store, typed.c_str(), 0, kFuzzyResults, results);
+		else
+			filter.SetQuery(typed.c_str());
+		double sync = now() - start;
+
+		start = now();
+		uint32 generation = fuzzy
+			? worker.StartFuzzy(typed.c_str(), 0, kFuzzyResults)
+			: worker.Start(typed.c_str());
+		double block = now() - start;
+
+		double first = -1;
+		bool done = false;
+		while (!done) {
+			if (queue.Wait() != generation
+				|| !worker.GetMatches(generation, matches, done))
+				continue;
+			if (first < 0)
+				first = now() - start;
+		}
+		double finished = now() - start;
+
+		printf("%-20s %8d %10.2f %10.1f %10.2f %10.2f\n", typed.c_str(),
+			(int)matches.size(), sync * 1000, block * 1000000, first * 1000,
+			finished * 1000);
+	}
+	printf("\n");
+}
+
+
+static void
+cancel_queries(const ClipStore& store, const char* query, bool fuzzy)
+{
+	FilterWorker worker(store);
+
+	double total = 0;
+	double longest = 0;
+	for (int32 i = 0; i < kCancels; i++) {
+		if (fuzzy)
+			worker.StartFuzzy(query, 0, kFuzzyResults);
+		else {
+			// Nothing cached, every query scans
+			worker.Reset();
+			worker.Start(query);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+		double start = now();
+		worker.Cancel();
+		double elapsed = now() - start;
+		total += elapsed;
+		if (elapsed > longest)
+			longest = elapsed;
+	}
+
+	printf("cancel %-6s %-13s average %8.1f us, longest %8.1f us\n",
+		fuzzy ? "fuzzy" : "substr", query, total * 1000000 / kCancels,
+		longest * 1000000);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 count = argc > 1 ? atoi(argv[1]) : 100000;
+	const char* query = argc > 2 ? argv[2] : "clipboard history";
+
+	ClipStore store(count);
+	Corpus corpus;
+	for (int32 i = 0; i < count; i++)
+		store.AddClip(corpus.NextClip(CORPUS_MIXED), "", "", i * 60, i * 60);
+
+	printf("%d clips\n\n", count);
+	type_query(store, query, false);
+	type_query(store, query, true);
+
+	cancel_queries(store, "e", false);
+	cancel_queries(store, "e", true);
+	return 0;
+}
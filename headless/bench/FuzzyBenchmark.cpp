@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Per-keystroke latency of the ranked fuzzy filter: types a query one
+ * character at a time and ranks the whole history after each one.
+ */
+
+#include <chrono>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FuzzyMatcher.h"
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 count = argc > 1 ? atoi(argv[1]) : 50000;
+	const char* query = argc > 2 ? argv[2] : "clipboard history";
+	int32 top = 500;
+
+	ClipStore store(count);
+	Corpus corpus;
+	for (int32 i = 0; i < count; i++)
+		store.AddClip(corpus.NextClip(CORPUS_MIXED), "", "", i * 60, i * 60);
+
+	printf("%d clips, top %d\n\n", count, top);
+	printf("%-20s %8s %10s\n", "query", "results", "ms");
+
+	bigtime_t time = count * 60;
+	std::vector<FuzzyResult> results;
+	std::string typed;
+	double total = 0;
+	for (size_t i = 0; i < strlen(query); i++) {
+		typed += query[i];
+
+		double start = now();
+		rank_clips(store, typed.c_str(), time, top, results);
+		double elapsed = now() - start;
+		total += elapsed;
+
+		printf("%-20s %8d %10.2f\n", typed.c_str(), (int)results.size(),
+			elapsed * 1000);
+	}
+	printf("\naverage per keystroke: %.2f ms\n", total * 1000 / strlen(query));
+	return 0;
+}
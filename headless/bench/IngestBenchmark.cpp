@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Adds large clips to the history, once the way MainWindow used to, with
+ * a copy of the clip for every step on the way into the store, and once
+ * through a single shared ClipBuffer. Counts the copies and their cost.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include "ClipBuffer.h"
+#include "ClipStore.h"
+#include "FileWriter.h"
+
+
+struct ingest_result {
+	int64		copies;
+	int64		bytes;
+	bigtime_t	time;
+};
+
+
+static void
+ingest_copying(ClipStore& store, const std::string& clipboard,
+	ingest_result& result)
+{
+	clip_buffer_stats before;
+	ClipBuffer::GetStats(before);
+	bigtime_t start = monotonic_time();
+
+	// _GetClipboard(), then _MakeItemUnique() and _AddClip() with their
+	// own std::string each, copied again by the store
+	std::string clip(clipboard.data(), clipboard.length());
+	store.MakeUnique(std::string(clip.data(), clip.length()));
+	store.AddClip(std::string(clip.data(), clip.length()), "", "", 0, 0);
+
+	result.time += monotonic_time() - start;
+	clip_buffer_stats after;
+	ClipBuffer::GetStats(after);
+	result.copies += 3 + after.allocations - before.allocations;
+	result.bytes += 3 * clip.length() + after.bytes_copied
+		- before.bytes_copied;
+}
+
+
+static void
+ingest_shared(ClipStore& store, const std::string& clipboard,
+	ingest_result& result)
+{
+	clip_buffer_stats before;
+	ClipBuffer::GetStats(before);
+	bigtime_t start = monotonic_time();
+
+	ClipBufferRef clip = ClipBuffer::Create(clipboard.data(),
+		clipboard.length());
+	store.MakeUnique(*clip);
+	store.AddClip(clip, "", "", 0, 0);
+
+	result.time += monotonic_time() - start;
+	clip_buffer_stats after;
+	ClipBuffer::GetStats(after);
+	result.copies += after.allocations - before.allocations;
+	result.bytes += after.bytes_copied - before.bytes_copied;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 count = argc > 1 ? atoi(argv[1]) : 20;
+	static const size_t kSizes[] = { 1 << 20, 8 << 20, 32 << 20 };
+
+	printf("%8s %10s %12s %14s %10s\n", "MB", "path", "copies/clip",
+		"MB copied/clip", "ms/clip");
+
+	for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); i++) {
+		for (int path = 0; path < 2; path++) {
+			ClipStore store(10);
+			ingest_result result = { 0, 0, 0 };
+			for (int32 j = 0; j < count; j++) {
+				std::string clipboard(kSizes[i], 'a' + j % 26);
+				clipboard[0] = (char)j;
+				if (path == 0)
+					ingest_copying(store, clipboard, result);
+				else
+					ingest_shared(store, clipboard, result);
+			}
+
+			printf("%8zu %10s %12.1f %14.1f %10.2f\n", kSizes[i] >> 20,
+				path == 0 ? "copying" : "shared", (double)result.copies / count,
+				(double)result.bytes / count / (1 << 20),
+				result.time / 1000.0 / count);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * What the history list costs for longer histories. It used to be a
+ * BListView with an item per clip, now ClipView only creates them for the
+ * rows in view (see VisibleRows.h), and filtering only sets the store
+ * indexes of the matches. An item is modelled by its display text and
+ * fade level, the way ClipView uses VisibleRows and RowCache is followed
+ * closely.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FadeSchedule.h"
+#include "VisibleRows.h"
+
+
+static const int32 kOverscan = 10;		// kHistoryOverscan
+static const float kRowHeight = 20;
+static const float kViewHeight = 400;
+static const int32 kDisplayChars = 80;
+static const int32 kScrolls = 2000;
+static const int32 kFilters = 200;
+
+
+struct item {
+	const ClipRecord*	record;
+	std::string			display;
+	int32				level;
+};
+
+
+class history_list {
+public:
+						history_list(const ClipStore& store)
+							:
+							fStore(store),
+							fFiltered(false),
+							fLayout(kOverscan),
+							fTop(0)
+						{
+							fLayout.SetRowHeight(kRowHeight);
+							fFade.SetTo(3600, 5);
+							_RowsChanged();
+						}
+
+	void				ShowOnly(const std::vector<int32>& indexes)
+						{
+							fShown = indexes;
+							fFiltered = true;
+							_RowsChanged();
+						}
+
+	void				ShowAll()
+						{
+							fShown.clear();
+							fFiltered = false;
+							_RowsChanged();
+						}
+
+	void				ScrollTo(float top)
+						{
+							fTop = top;
+							_Trim();
+						}
+
+	// Returns the number of rows drawn
+	int32				Draw(bigtime_t now)
+						{
+							int32 first;
+							int32 last;
+							if (!fLayout.RowsIn(fTop, fTop + kViewHeight - 1,
+									first, last))
+								return 0;
+							for (int32 i = first; i <= last; i++) {
+								item* row = _ItemAt(i);
+								row->level = fFade.LevelAt(
+									row->record->GetTimeSince(), now);
+							}
+							return last - first + 1;
+						}
+
+	float				Height() const { return fLayout.Height(); }
+	int32				CountItems() const { return fItems.CountItems(); }
+
+private:
+	int32				_CountRows() const
+						{
+							return fFiltered ? (int32)fShown.size()
+								: fStore.CountClips();
+						}
+
+	ClipRecord*			_RowAt(int32 index) const
+						{
+							return fStore.ClipAt(
+								fFiltered ? fShown[index] : index);
+						}
+
+	void				_RowsChanged()
+						{
+							fLayout.SetCount(_CountRows());
+							fTop = std::min(fTop, std::max(0.0f,
+								fLayout.Height() - kViewHeight));
+							_Trim();
+						}
+
+	item*				_ItemAt(int32 index)
+						{
+							ClipRecord* record = _RowAt(index);
+							item* row = fItems.Get(record->GetId());
+							if (row == NULL || row->record != record) {
+								row = new item;
+								row->record = record;
+								row->display.assign(record->GetPreviewData(),
+									std::min((size_t)kDisplayChars,
+										record->GetPreviewLength()));
+								fItems.Put(record->GetId(), row);
+							}
+							return row;
+						}
+
+	void				_Trim()
+						{
+							int32 first;
+							int32 last;
+							if (fLayout.RowsAround(fTop,
+									fTop + kViewHeight - 1, first, last)) {
+								for (int32 i = first; i <= last; i++)
+									fItems.Retain(_RowAt(i)->GetId());
+							}
+							fItems.Trim();
+						}
+
+	const ClipStore&	fStore;
+	bool				fFiltered;
+	std::vector<int32>	fShown;
+	VisibleRows			fLayout;
+	RowCache<uint32, item> fItems;
+	FadeSchedule		fFade;
+	float				fTop;
+};
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+int
+main()
+{
+	static const int32 kCounts[] = { 100, 1000, 10000, 100000 };
+	bigtime_t time = 1700000000;
+
+	printf("%8s %16s %12s %12s %8s\n", "clips", "item per clip ms",
+		"scroll us", "filter us", "items");
+
+	for (size_t i = 0; i < sizeof(kCounts) / sizeof(kCounts[0]); i++) {
+		int32 count = kCounts[i];
+		ClipStore store(count);
+		Corpus corpus;
+		for (int32 j = 0; j < count; j++) {
+			bigtime_t added = time - (count - j) * 30;
+			store.AddClip(corpus.NextClip(CORPUS_SHORT), "",
+				"/boot/system/apps/Terminal", added, added);
+		}
+
+		std::vector<ClipRecord*> records;
+		for (int32 j = 0; j < store.CountClips(); j++)
+			records.push_back(store.ClipAt(j));
+
+		// Before: an item for every clip, whether it's shown or not
+		double start = now();
+		std::vector<item*> all;
+		all.reserve(records.size());
+		for (size_t j = 0; j < records.size(); j++) {
+			item* row = new item;
+			row->record = records[j];
+			row->display.assign(records[j]->GetPreviewData(),
+				std::min((size_t)kDisplayChars,
+					records[j]->GetPreviewLength()));
+			row->level = 0;
+			all.push_back(row);
+		}
+		double itemPerClip = now() - start;
+		for (size_t j = 0; j < all.size(); j++)
+			delete all[j];
+
+		history_list view(store);
+		view.Draw(time);
+
+		// Jumping anywhere, e.g. by dragging the scroll bar
+		srand(1);
+		int32 drawn = 0;
+		start = now();
+		for (int32 round = 0; round < kScrolls; round++) {
+			float top = (float)rand() / RAND_MAX
+				* std::max(0.0f, view.Height() - kViewHeight);
+			view.ScrollTo(top);
+			drawn += view.Draw(time);
+		}
+		double scroll = (now() - start) / kScrolls;
+
+		// Showing the matches of a filter, and all clips again. Finding
+		// them is up to ClipFilter.
+		std::vector<int32> matches;
+		for (int32 j = 0; j < store.CountClips(); j += 50)
+			matches.push_back(j);
+		start = now();
+		for (int32 round = 0; round < kFilters; round++) {
+			if (round % 2 == 0)
+				view.ShowOnly(matches);
+			else
+				view.ShowAll();
+			drawn += view.Draw(time);
+		}
+		double filter = (now() - start) / kFilters;
+
+		printf("%8d %16.3f %12.2f %12.2f %8d\n", count, itemPerClip * 1000,
+			scroll * 1000000, filter * 1000000, view.CountItems());
+		if (drawn == 0)
+			printf("nothing drawn\n");
+	}
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Startup cost of the history: how long it takes to open the journal and
+ * how much of it becomes resident, before and after every clip has been
+ * looked at once. Also when the history is loaded in the background like
+ * MainWindow does: until a clip can be captured, and until it's merged
+ * with all of the history.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FileWriter.h"
+#include "HistoryJournal.h"
+#include "HistoryLoader.h"
+#include "TextSearch.h"
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Resident set size in MB, where the system tells us
+static double
+resident()
+{
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file == NULL)
+		return 0;
+
+	long pages = 0;
+	long residentPages = 0;
+	if (fscanf(file, "%ld %ld", &pages, &residentPages) != 2)
+		residentPages = 0;
+	fclose(file);
+	return residentPages * (double)sysconf(_SC_PAGESIZE) / (1024 * 1024);
+}
+
+
+// Like MainWindow at startup: a clip is captured right away, and merged
+// with the history once that's loaded in the background
+static void
+load_in_background(const char* path, const char* indexPath, int32 count,
+	double& capture, double& all)
+{
+	double start = now();
+	FileWriter writer;
+	ClipStore store(count);
+
+	std::mutex lock;
+	std::condition_variable condition;
+	bool loaded = false;
+	HistoryLoader loader(writer);
+	loader.Start(path, indexPath, store, [&](status_t) {
+		std::lock_guard<std::mutex> _(lock);
+		loaded = true;
+		condition.notify_one();
+	});
+	store.AddClip("captured while loading", "", "", count, count);
+	capture = now() - start;
+
+	{
+		std::unique_lock<std::mutex> waitLock(lock);
+		condition.wait(waitLock, [&] { return loaded; });
+	}
+	HistoryJournal journal(writer);
+	journal.Attach(path, store, loader.CountRecords());
+	store.MergeOlder(loader.Store());
+	all = now() - start;
+
+	journal.Close(count);
+	writer.Flush();
+}
+
+
+int
+main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : "load_benchmark.journal";
+	std::string indexPath = std::string(path) + ".index";
+	static const int32 kCounts[] = { 1000, 5000, 20000 };
+
+	printf("%8s %10s %10s %12s %12s %11s %10s\n", "clips", "MB", "open ms",
+		"resident MB", "scanned MB", "capture ms", "all ms");
+
+	for (size_t i = 0; i < sizeof(kCounts) / sizeof(kCounts[0]); i++) {
+		int32 count = kCounts[i];
+		size_t bytes = 0;
+		{
+			ClipStore store(count);
+			Corpus corpus;
+			for (int32 j = 0; j < count; j++) {
+				std::string clip = corpus.NextClip(CORPUS_MIXED);
+				bytes += clip.length();
+				store.AddClip(clip, "", "/boot/system/apps/Terminal", j, j);
+			}
+
+			FileWriter writer;
+			HistoryJournal journal(writer);
+			journal.Create(path, store);
+			journal.Close(count);
+			writer.Flush();
+			store.SaveIndex(indexPath.c_str());
+		}
+
+		double before = resident();
+		double start = now();
+
+		ClipStore store(count);
+		store.SuspendIndex();
+		FileWriter writer;
+		HistoryJournal journal(writer);
+		bigtime_t quitTime;
+		journal.Open(path, store, &quitTime);
+
+		double elapsed = now() - start;
+		double opened = resident();
+
+		// Touch every clip, like a filter does
+		TextMatcher matcher("zqxj");
+		int32 matches = 0;
+		for (int32 j = 0; j < store.CountClips(); j++) {
+			const ClipRecord* record = store.ClipAt(j);
+			if (matcher.Matches(record->GetClipData(), record->GetClipLength()))
+				matches++;
+		}
+
+		double scanned = resident();
+		journal.Close(count);
+		writer.Flush();
+
+		double capture;
+		double all;
+		load_in_background(path, indexPath.c_str(), count, capture, all);
+
+		printf("%8d %10.1f %10.2f %12.1f %12.1f %11.2f %10.2f\n",
+			store.CountClips(), bytes / (1024.0 * 1024), elapsed * 1000,
+			opened - before, scanned - before, capture * 1000, all * 1000);
+	}
+
+	remove(path);
+	remove(indexPath.c_str());
+	return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * How the substring filter scales with the threads of a ParallelSearch,
+ * from one to all cores. Each query starts without cached results, and
+ * the matches are checked against ClipFilter::SetQuery(). Queries of less
+ * than three characters can't use the trigram index and scan every clip.
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ClipFilter.h"
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "ParallelSearch.h"
+
+
+static const char* kQueries[] = {
+	"e", "th", "the", "clipboard", "error 4", "zqxj", "straße"
+};
+static const size_t kQueryCount = sizeof(kQueries) / sizeof(kQueries[0]);
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 count = argc > 1 ? atoi(argv[1]) : 100000;
+	int32 maxThreads = argc > 2 ? atoi(argv[2])
+		: (int32)std::thread::hardware_concurrency();
+	int32 distribution = argc > 3 ? atoi(argv[3]) : CORPUS_MIXED;
+	if (maxThreads < 1)
+		maxThreads = 1;
+
+	ClipStore store(count);
+	Corpus corpus;
+	for (int32 i = 0; i < count; i++)
+		store.AddClip(corpus.NextClip(distribution), "", "", i * 60, i * 60);
+
+	uint64 bytes = 0;
+	for (int32 i = 0; i < store.CountClips(); i++)
+		bytes += store.ClipAt(i)->GetClipLength();
+
+	std::vector<std::vector<int32> > expected(kQueryCount);
+	for (size_t q = 0; q < kQueryCount; q++) {
+		ClipFilter filter(store);
+		filter.SetQuery(kQueries[q]);
+		expected[q] = filter.Matches();
+	}
+
+	printf("%d %s clips, %.1f MB, %u cores\n\n", (int)store.CountClips(),
+		Corpus::DistributionName(distribution), bytes / (1024.0 * 1024),
+		std::thread::hardware_concurrency());
+	printf("%-8s", "threads");
+	for (size_t q = 0; q < kQueryCount; q++)
+		printf(" %10s", kQueries[q]);
+	printf(" %10s %8s\n", "total ms", "speedup");
+
+	double single = 0;
+	for (int32 threads = 1; threads <= maxThreads; threads++) {
+		ParallelSearch search(threads);
+		ClipFilter filter(store);
+
+		printf("%-8d", (int)threads);
+		double total = 0;
+		bool wrong = false;
+		for (size_t q = 0; q < kQueryCount; q++) {
+			filter.Reset();
+			double start = now();
+			filter.Begin(kQueries[q]);
+			filter.Finish(search, ParallelSearch::CancelFunction(),
+				ParallelSearch::ProgressFunction());
+			double elapsed = now() - start;
+			total += elapsed;
+			wrong |= filter.Matches() != expected[q];
+
+			printf(" %10.2f", elapsed * 1000);
+		}
+		if (threads == 1)
+			single = total;
+
+		printf(" %10.2f %7.2fx%s\n", total * 1000, single / total,
+			wrong ? "  WRONG MATCHES" : "");
+	}
+	return 0;
+}
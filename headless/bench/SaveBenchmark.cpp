@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * A burst of clipboard changes with the history journal saved through the
+ * FileWriter, for a few coalescing delays. Shows what saving costs the
+ * window thread and how many writes actually hit the disk.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FileWriter.h"
+#include "HistoryJournal.h"
+
+
+int
+main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : "save_benchmark.journal";
+	int32 count = argc > 2 ? atoi(argv[2]) : 1000;
+	static const bigtime_t kDelays[] = { 0, 50000, 500000 };
+
+	printf("%10s %8s %10s %10s %8s %8s %12s %12s\n", "delay ms", "changes",
+		"avg us", "max us", "writes", "skipped", "avg lat ms", "max lat ms");
+
+	Corpus corpus;
+	for (size_t i = 0; i < sizeof(kDelays) / sizeof(kDelays[0]); i++) {
+		remove(path);
+
+		FileWriter writer(kDelays[i]);
+		ClipStore store(100);
+		HistoryJournal journal(writer);
+		journal.Create(path, store);
+
+		bigtime_t total = 0;
+		bigtime_t worst = 0;
+		for (int32 j = 0; j < count; j++) {
+			std::string clip = corpus.NextClip(CORPUS_MIXED);
+
+			bigtime_t start = monotonic_time();
+			store.MakeUnique(clip);
+			store.AddClip(clip, "", "/boot/system/apps/Terminal", j, j);
+			bigtime_t elapsed = monotonic_time() - start;
+
+			total += elapsed;
+			worst = std::max(worst, elapsed);
+			// Someone copying things in quick succession
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		journal.Close(count);
+		writer.Flush();
+
+		writer_stats stats;
+		writer.GetStats(stats);
+		printf("%10.0f %8d %10.1f %10lld %8lld %8lld %12.2f %12.2f\n",
+			kDelays[i] / 1000.0, count, (double)total / count, (long long)worst,
+			(long long)stats.writes, (long long)stats.skipped,
+			stats.writes > 0 ? stats.total_latency / 1000.0 / stats.writes : 0,
+			stats.max_latency / 1000.0);
+	}
+
+	remove(path);
+	return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Compares TextMatcher's search kernels with libc's strcasestr() on a
+ * corpus of clips. Note that strcasestr() only folds ASCII, so it finds
+ * less for non-ASCII queries. This is about speed.
+ */
+
+#include <chrono>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Corpus.h"
+#include "TextSearch.h"
+
+
+static const char* kQueries[] = {
+	"the", "clipboard", "HAIKU", "error 4", "zqxj", "straße", "ÜBER", "привет",
+	"ΣΟΦΊΑ"
+};
+static const size_t kQueryCount = sizeof(kQueries) / sizeof(kQueries[0]);
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+static void
+run(const char* kernel, const char* query, const std::vector<std::string>& clips,
+	size_t bytes, int32 rounds)
+{
+	TextMatcher matcher(query);
+	int32 matches = 0;
+	double start = now();
+	for (int32 round = 0; round < rounds; round++) {
+		matches = 0;
+		for (size_t i = 0; i < clips.size(); i++) {
+			bool found;
+			if (kernel == NULL)
+				found = strcasestr(clips[i].c_str(), query) != NULL;
+			else
+				found = matcher.Matches(clips[i]);
+			matches += found ? 1 : 0;
+		}
+	}
+	double seconds = (now() - start) / rounds;
+
+	printf("%-12s %-12s %8d %10.2f %10.1f\n", kernel != NULL ? kernel : "strcasestr",
+		query, matches, seconds * 1000, bytes / seconds / (1024 * 1024));
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 count = argc > 1 ? atoi(argv[1]) : 20000;
+	int32 rounds = argc > 2 ? atoi(argv[2]) : 3;
+
+	std::vector<std::string> clips;
+	Corpus corpus;
+	corpus.Generate(count, CORPUS_MIXED, clips);
+
+	size_t bytes = 0;
+	for (size_t i = 0; i < clips.size(); i++)
+		bytes += clips[i].length();
+
+	printf("%d clips, %.1f MB\n\n", count, bytes / (1024.0 * 1024));
+	printf("%-12s %-12s %8s %10s %10s\n", "kernel", "query", "matches", "ms", "MB/s");
+
+	static const int32 kKernels[] = {
+		SEARCH_KERNEL_SCALAR, SEARCH_KERNEL_SSE2, SEARCH_KERNEL_AVX2
+	};
+
+	for (size_t q = 0; q < kQueryCount; q++) {
+		run(NULL, kQueries[q], clips, bytes, rounds);
+		for (size_t k = 0; k < sizeof(kKernels) / sizeof(kKernels[0]); k++) {
+			if (!set_search_kernel(kKernels[k]))
+				continue;
+			run(search_kernel_name(), kQueries[q], clips, bytes, rounds);
+		}
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * What switching the theme costs. MainWindow used to reload the history
+ * from disk for it: the journal was replayed, every list item was created
+ * again and tinted on its own. Now the view only recomputes the color of
+ * each fade level and the items that are visible get theirs when they're
+ * drawn. The items are modelled by a row with its display text and color,
+ * tint_color() by a function that does about the same work.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+
+#include "ClipStore.h"
+#include "Corpus.h"
+#include "FadeSchedule.h"
+#include "FileWriter.h"
+#include "HistoryJournal.h"
+
+
+static const int32 kRounds = 15;
+static const int32 kVisibleRows = 40;
+static const int32 kDisplayChars = 80;
+
+// The default fade settings, see Constants.h
+static const bigtime_t kFadeInterval = 6 * 10 * 60;
+static const int32 kFadeSteps = 5;
+static const float kMaxTint = 1.0 + 0.025 * 8;
+
+
+struct color {
+	uint8				red;
+	uint8				green;
+	uint8				blue;
+};
+
+
+struct row {
+	const ClipRecord*	record;
+	std::string			display;
+	int32				level;
+	color				background;
+};
+
+
+static double
+now()
+{
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// Darkens for tints above 1, lightens below, like Haiku's tint_color()
+static color
+tint(color base, float tint)
+{
+	color result;
+	if (tint > 1) {
+		float factor = 2 - tint;
+		result.red = (uint8)(base.red * factor);
+		result.green = (uint8)(base.green * factor);
+		result.blue = (uint8)(base.blue * factor);
+	} else {
+		float factor = 1 - tint;
+		result.red = (uint8)(base.red + (255 - base.red) * factor);
+		result.green = (uint8)(base.green + (255 - base.green) * factor);
+		result.blue = (uint8)(base.blue + (255 - base.blue) * factor);
+	}
+	return result;
+}
+
+
+static float
+level_tint(int32 level)
+{
+	return 1 + (kMaxTint - 1) * level / kFadeSteps;
+}
+
+
+static double
+median(std::vector<double>& samples)
+{
+	std::sort(samples.begin(), samples.end());
+	return samples[samples.size() / 2];
+}
+
+
+// Before: replay the journal, create the rows again and tint each one
+static double
+reload(const char* path, const char* indexPath, const color& background,
+	bigtime_t time, const FadeSchedule& fade, int32 count)
+{
+	double start = now();
+
+	ClipStore store(count);
+	store.SuspendIndex();
+	FileWriter writer;
+	HistoryJournal journal(writer);
+	bigtime_t quitTime;
+	journal.Open(path, store, &quitTime);
+	store.LoadIndex(indexPath);
+
+	std::vector<row*> rows;
+	rows.reserve(store.CountClips());
+	for (int32 i = 0; i < store.CountClips(); i++) {
+		row* item = new row;
+		item->record = store.ClipAt(i);
+		item->display.assign(item->record->GetPreviewData(),
+			std::min((size_t)kDisplayChars,
+				(size_t)item->record->GetPreviewLength()));
+		item->level = fade.LevelAt(item->record->GetTimeSince(), time);
+		item->background = tint(background, level_tint(item->level));
+		rows.push_back(item);
+	}
+	double elapsed = now() - start;
+
+	journal.Close(quitTime);
+	for (size_t i = 0; i < rows.size(); i++)
+		delete rows[i];
+	return elapsed;
+}
+
+
+// Now: a color per level, and the drawn rows look theirs up
+static double
+recolor(std::vector<row>& rows, int32 visible, const color& background,
+	bigtime_t time, const FadeSchedule& fade)
+{
+	double start = now();
+
+	std::vector<color> colors;
+	for (int32 i = 0; i <= fade.CountSteps(); i++)
+		colors.push_back(tint(background, level_tint(i)));
+
+	for (int32 i = 0; i < visible && i < (int32)rows.size(); i++) {
+		row& item = rows[i];
+		item.level = fade.LevelAt(item.record->GetTimeSince(), time);
+		item.background = colors[item.level];
+	}
+	return now() - start;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	std::string path = argc > 1 ? argv[1] : "theme_benchmark.journal";
+	std::string indexPath = path + ".index";
+	static const int32 kCounts[] = { 1000, 10000 };
+
+	FadeSchedule fade;
+	fade.SetTo(kFadeInterval, kFadeSteps);
+	color themes[2] = { { 216, 216, 216 }, { 40, 40, 40 } };
+
+	printf("%8s %12s %12s %14s %10s\n", "clips", "reload ms", "recolor ms",
+		"all rows ms", "speedup");
+
+	for (size_t i = 0; i < sizeof(kCounts) / sizeof(kCounts[0]); i++) {
+		int32 count = kCounts[i];
+		// Spread over the last few days, so the clips are at all levels
+		bigtime_t time = 1700000000;
+		ClipStore store(count);
+		{
+			Corpus corpus;
+			for (int32 j = 0; j < count; j++) {
+				bigtime_t added = time - (count - j) * 30;
+				store.AddClip(corpus.NextClip(CORPUS_MIXED), "",
+					"/boot/system/apps/Terminal", added, added);
+			}
+			FileWriter writer;
+			HistoryJournal journal(writer);
+			journal.Create(path.c_str(), store);
+			journal.Close(time);
+			writer.Flush();
+			store.SaveIndex(indexPath.c_str());
+		}
+
+		std::vector<row> rows(store.CountClips());
+		for (int32 j = 0; j < store.CountClips(); j++) {
+			rows[j].record = store.ClipAt(j);
+			rows[j].level = 0;
+		}
+
+		std::vector<double> reloads;
+		std::vector<double> recolors;
+		std::vector<double> all;
+		for (int32 round = 0; round < kRounds; round++) {
+			const color& background = themes[round % 2];
+			reloads.push_back(reload(path.c_str(), indexPath.c_str(),
+				background, time, fade, count));
+			recolors.push_back(recolor(rows, kVisibleRows, background, time,
+				fade));
+			all.push_back(recolor(rows, rows.size(), background, time, fade));
+		}
+
+		double reloaded = median(reloads);
+		double recolored = median(recolors);
+		printf("%8d %12.3f %12.4f %14.3f %9.0fx\n", count, reloaded * 1000,
+			recolored * 1000, median(all) * 1000,
+			reloaded / std::max(recolored, 1e-9));
+	}
+
+	remove(path.c_str());
+	remove(indexPath.c_str());
+	return 0;
+}
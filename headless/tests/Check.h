@@ -0,0 +1,71 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * What the tests in tests/ share. CHECK() reports a failed condition and
+ * goes on, main() returns check_result(). Files go to a directory of
+ * their own that's removed again.
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+
+static int sFailures = 0;
+
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, \
+				#condition); \
+			sFailures++; \
+		} \
+	} while (false)
+
+
+static inline std::string
+make_test_directory(const char* name)
+{
+	std::string path = std::string("/tmp/clipdinger-") + name + "-XXXXXX";
+	if (mkdtemp(&path[0]) == NULL) {
+		perror("mkdtemp");
+		exit(1);
+	}
+	return path;
+}
+
+
+static inline int
+remove_entry(const char* path, const struct stat*, int, struct FTW*)
+{
+	return remove(path);
+}
+
+
+static inline void
+remove_test_directory(const std::string& path)
+{
+	nftw(path.c_str(), remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+
+static inline int
+check_result(const char* name)
+{
+	if (sFailures != 0) {
+		fprintf(stderr, "%s: %d checks failed\n", name, sFailures);
+		return 1;
+	}
+	printf("%s: passed\n", name);
+	return 0;
+}
+
+#endif // CHECK_H
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * ClipStore eviction: the clip limit drops the oldest clips, the byte
+ * budget large, old ones that were never pasted, but never the newest.
+ * The removed indexes are reported in the order they were removed.
+ */
+
+#include <vector>
+
+#include "Check.h"
+#include "ClipStore.h"
+
+
+static std::string
+clip(char c, size_t length)
+{
+	return std::string(length, c);
+}
+
+
+static std::string
+first_bytes(const ClipStore& store)
+{
+	std::string bytes;
+	for (int32 i = 0; i < store.CountClips(); i++)
+		bytes += store.ClipAt(i)->GetClipData()[0];
+	return bytes;
+}
+
+
+static void
+test_clip_limit()
+{
+	ClipStore store(3);
+	std::vector<int32> removed;
+	for (char c = 'a'; c <= 'c'; c++)
+		CHECK(store.AddClip(clip(c, 10), "", "", 0, 0, &removed) == 0);
+	CHECK(removed.empty());
+
+	CHECK(store.AddClip(clip('d', 10), "", "", 0, 0, &removed) == 1);
+	CHECK(store.AddClip(clip('e', 10), "", "", 0, 0, &removed) == 1);
+	std::vector<int32> expected = { 2, 2 };
+	CHECK(removed == expected);
+	CHECK(first_bytes(store) == "edc");
+
+	CHECK(store.Crop(0) == 2);
+	CHECK(first_bytes(store) == "e");
+}
+
+
+static void
+test_byte_limit()
+{
+	ClipStore store(100);
+	store.SetByteLimit(1000);
+	store.AddClip(clip('b', 600), "", "", 0, 0);
+	store.AddClip(clip('s', 100), "", "", 0, 0);
+	store.AddClip(clip('t', 100), "", "", 0, 0);
+	CHECK(store.CountBytes() == 800);
+
+	// The large old one goes, not the small ones above it
+	std::vector<int32> removed;
+	CHECK(store.AddClip(clip('n', 300), "", "", 0, 0, &removed) == 1);
+	std::vector<int32> expected = { 2 };
+	CHECK(removed == expected);
+	CHECK(first_bytes(store) == "nts");
+	CHECK(store.CountBytes() == 500);
+}
+
+
+static void
+test_pasted()
+{
+	ClipStore store(100);
+	store.SetByteLimit(1000);
+	store.AddClip(clip('a', 300), "", "", 0, 0);
+	store.AddClip(clip('b', 300), "", "", 0, 0);
+	store.AddClip(clip('c', 200), "", "", 0, 0);
+	store.ClipAt(2)->SetPasted(true);
+
+	// Without the paste, 'a' would be the one to go
+	CHECK(store.AddClip(clip('n', 400), "", "", 0, 0) == 1);
+	CHECK(first_bytes(store) == "nca");
+	CHECK(store.CountBytes() <= store.ByteLimit());
+}
+
+
+static void
+test_newest_kept()
+{
+	ClipStore store(100);
+	store.SetByteLimit(1000);
+	store.AddClip(clip('a', 100), "", "", 0, 0);
+	store.AddClip(clip('b', 100), "", "", 0, 0);
+
+	// Over budget on its own, it's kept anyway
+	CHECK(store.AddClip(clip('h', 1500), "", "", 0, 0) == 2);
+	CHECK(first_bytes(store) == "h");
+	CHECK(store.CountBytes() == 1500);
+
+	// Lowering the budget keeps the newest as well
+	ClipStore unlimited(100);
+	unlimited.AddClip(clip('a', 100), "", "", 0, 0);
+	unlimited.AddClip(clip('s', 100), "", "", 0, 0);
+	std::vector<int32> removed;
+	CHECK(unlimited.SetByteLimit(50, &removed) == 1);
+	std::vector<int32> expected = { 1 };
+	CHECK(removed == expected);
+	CHECK(first_bytes(unlimited) == "s");
+	CHECK(unlimited.CountBytes() == 100);
+}
+
+
+int
+main()
+{
+	test_clip_limit();
+	test_byte_limit();
+	test_pasted();
+	test_newest_kept();
+	return check_result("eviction_test");
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * FilterWorker: a new query cancels the one in flight, a cancelled query
+ * isn't announced anymore, and Cancel() returns while the target can't
+ * take the announcement, like a window with a full port. The matches are
+ * the ones ClipFilter and rank_clips() find.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Check.h"
+#include "ClipFilter.h"
+#include "ClipStore.h"
+#include "FilterWorker.h"
+#include "FuzzyMatcher.h"
+
+
+static const int32 kClips = 20000;
+static const int32 kFuzzyResults = 50;
+
+
+// Stands in for the window's port
+class found_port {
+public:
+						found_port()
+							:
+							fFull(false)
+						{
+						}
+
+	bool				Post(uint32 generation, bigtime_t timeout)
+						{
+							std::unique_lock<std::mutex> lock(fLock);
+							if (fFull) {
+								fCondition.wait_for(lock,
+									std::chrono::microseconds(timeout),
+									[this] { return !fFull; });
+								if (fFull)
+									return false;
+							}
+							fPosted.push_back(generation);
+							fCondition.notify_all();
+							return true;
+						}
+
+	void				SetFull(bool full)
+						{
+							std::lock_guard<std::mutex> lock(fLock);
+							fFull = full;
+							fCondition.notify_all();
+						}
+
+	// Takes the announcement of 'generation'
+	bool				Wait(uint32 generation)
+						{
+							std::unique_lock<std::mutex> lock(fLock);
+							bool posted = fCondition.wait_for(lock,
+								std::chrono::seconds(10), [&] {
+									return _Find(generation)
+										!= fPosted.end();
+								});
+							if (posted)
+								fPosted.erase(_Find(generation));
+							return posted;
+						}
+
+	std::vector<uint32>	Posted()
+						{
+							std::lock_guard<std::mutex> lock(fLock);
+							return fPosted;
+						}
+
+	void				Clear()
+						{
+							std::lock_guard<std::mutex> lock(fLock);
+							fPosted.clear();
+						}
+
+private:
+	std::vector<uint32>::iterator _Find(uint32 generation)
+						{
+							return std::find(fPosted.begin(), fPosted.end(),
+								generation);
+						}
+
+	std::mutex			fLock;
+	std::condition_variable fCondition;
+	std::vector<uint32>	fPosted;
+	bool				fFull;
+};
+
+
+static bool
+wait_until_done(FilterWorker& worker, found_port& port, uint32 generation,
+	std::vector<int32>& matches)
+{
+	bool done = false;
+	while (!done) {
+		if (!port.Wait(generation)
+			|| !worker.GetMatches(generation, matches, done))
+			return false;
+	}
+	return true;
+}
+
+
+static std::vector<int32>
+filter(const ClipStore& store, const char* query)
+{
+	ClipFilter filter(store);
+	filter.SetQuery(query);
+	return filter.Matches();
+}
+
+
+static std::vector<int32>
+rank(const ClipStore& store, const char* query)
+{
+	std::vector<FuzzyResult> results;
+	rank_clips(store, query, 0, kFuzzyResults, results);
+	std::vector<int32> indexes;
+	for (size_t i = 0; i < results.size(); i++)
+		indexes.push_back(results[i].index);
+	return indexes;
+}
+
+
+static void
+test_superseded(const ClipStore& store, FilterWorker& worker,
+	found_port& port)
+{
+	uint32 first = worker.Start("e");
+	uint32 second = worker.Start("needle 1");
+	CHECK(second != first);
+
+	std::vector<int32> matches;
+	CHECK(wait_until_done(worker, port, second, matches));
+	CHECK(matches == filter(store, "needle 1"));
+	bool done;
+	CHECK(!worker.GetMatches(first, matches, done));
+
+	uint32 fuzzy = worker.StartFuzzy("ndl 2", 0, kFuzzyResults);
+	CHECK(wait_until_done(worker, port, fuzzy, matches));
+	CHECK(matches == rank(store, "ndl 2"));
+	port.Clear();
+}
+
+
+static void
+test_cancelled(FilterWorker& worker, found_port& port)
+{
+	uint32 generation = worker.Start("e");
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	worker.Cancel();
+	port.Clear();
+
+	// Nothing more is announced once Cancel() returned
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	CHECK(port.Posted().empty());
+	std::vector<int32> matches;
+	bool done;
+	CHECK(!worker.GetMatches(generation, matches, done));
+}
+
+
+static void
+test_full_port(const ClipStore& store, FilterWorker& worker,
+	found_port& port)
+{
+	// Cancelled while the worker is busy, and while it's done and waiting
+	// for the port
+	port.SetFull(true);
+	worker.Start("e");
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	worker.Cancel();
+
+	worker.Start("needle 3");
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	auto start = std::chrono::steady_clock::now();
+	worker.Cancel();
+	CHECK(std::chrono::steady_clock::now() - start
+		< std::chrono::milliseconds(50));
+	CHECK(port.Posted().empty());
+
+	// Once there's room again, announcements get through
+	port.SetFull(false);
+	uint32 generation = worker.Start("needle 4");
+	std::vector<int32> matches;
+	CHECK(wait_until_done(worker, port, generation, matches));
+	CHECK(matches == filter(store, "needle 4"));
+}
+
+
+int
+main()
+{
+	// A deadlock fails the test instead of hanging it
+	alarm(60);
+
+	ClipStore store(kClips);
+	for (int32 i = 0; i < kClips; i++) {
+		std::string clip = "clip " + std::to_string(i) + " ";
+		clip += std::string(1000 + i % 1000, 'a' + i % 26);
+		if (i % 7 == 0)
+			clip += " needle " + std::to_string(i % 10);
+		store.AddClip(clip, "", "", i, i);
+	}
+
+	found_port port;
+	FilterWorker worker(store, 4);
+	worker.SetFoundFunction([&port](uint32 generation, bigtime_t timeout) {
+		return port.Post(generation, timeout);
+	});
+
+	test_superseded(store, worker, port);
+	test_cancelled(worker, port);
+	test_full_port(store, worker, port);
+	return check_result("filter_worker_test");
+}
@@ -0,0 +1,390 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * HistoryJournal: a journal replays to what was logged, a record torn by
+ * a crash is cut off, a damaged record or clip is skipped and the journal
+ * rewritten, and one that can't be read at all is left alone. Blobs
+ * written in the background are found on replay.
+ */
+
+#include <sys/stat.h>
+
+#include <vector>
+
+#include "BlobStore.h"
+#include "Check.h"
+#include "ClipStore.h"
+#include "FileWriter.h"
+#include "HistoryJournal.h"
+
+
+static std::vector<std::string>
+clips_of(const ClipStore& store)
+{
+	std::vector<std::string> clips;
+	for (int32 i = 0; i < store.CountClips(); i++) {
+		const ClipRecord* record = store.ClipAt(i);
+		clips.push_back(std::string(record->GetClipData(),
+			record->GetClipLength()));
+	}
+	return clips;
+}
+
+
+static off_t
+file_size(const std::string& path)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+		return -1;
+	return st.st_size;
+}
+
+
+static std::string
+read_file(const std::string& path)
+{
+	std::string data;
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL)
+		return data;
+	char buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data.append(buffer, read);
+	fclose(file);
+	return data;
+}
+
+
+static void
+write_file(const std::string& path, const std::string& data)
+{
+	FILE* file = fopen(path.c_str(), "wb");
+	CHECK(file != NULL);
+	if (file == NULL)
+		return;
+	CHECK(fwrite(data.data(), 1, data.length(), file) == data.length());
+	fclose(file);
+}
+
+
+static void
+test_replay(const std::string& directory)
+{
+	std::string path = directory + "/replay";
+	FileWriter writer;
+	{
+		ClipStore store(100);
+		store.AddClip("one", "", "app", 1, 1);
+		store.AddClip("two", "", "app", 2, 2);
+		store.AddClip("three", "", "app", 3, 3);
+
+		HistoryJournal journal(writer);
+		journal.Create(path.c_str(), store);
+		store.AddClip("four", "", "other app", 4, 4);
+		store.MoveToTop(store.IndexOf(store.FindClip(std::string("one"))), 5);
+		store.SetTitle(store.FindClip(std::string("two")), "Two");
+		store.RemoveClip(store.IndexOf(store.FindClip(std::string("three"))));
+		journal.Close(6);
+	}
+	writer.Flush();
+
+	ClipStore store(100);
+	HistoryJournal journal(writer);
+	bigtime_t quitTime = 0;
+	CHECK(journal.Open(path.c_str(), store, &quitTime) == B_OK);
+	CHECK(quitTime == 6);
+
+	std::vector<std::string> expected = { "one", "four", "two" };
+	CHECK(clips_of(store) == expected);
+	if (store.CountClips() == 3) {
+		CHECK(store.ClipAt(0)->GetTimeAdded() == 5);
+		CHECK(store.ClipAt(1)->GetOrigin() == "other app");
+		CHECK(store.ClipAt(2)->GetTitle() == "Two");
+	}
+	journal.Close(7);
+	writer.Flush();
+}
+
+
+static void
+test_missing(const std::string& directory)
+{
+	FileWriter writer;
+	ClipStore store(100);
+	HistoryJournal journal(writer);
+	CHECK(journal.Open((directory + "/missing").c_str(), store, NULL)
+		== B_ENTRY_NOT_FOUND);
+	CHECK(!journal.IsOpen());
+}
+
+
+static void
+test_torn_tail(const std::string& directory)
+{
+	std::string path = directory + "/torn";
+	FileWriter writer;
+	off_t intact;
+	{
+		ClipStore store(100);
+		store.AddClip("one", "", "app", 1, 1);
+		store.AddClip("two", "", "app", 2, 2);
+		HistoryJournal journal(writer);
+		journal.Create(path.c_str(), store);
+		writer.Flush();
+		intact = file_size(path);
+
+		store.AddClip("three", "", "app", 3, 3);
+		writer.Flush();
+	}
+
+	// A crash in the middle of appending the last record
+	off_t size = file_size(path);
+	CHECK(size > intact);
+	CHECK(truncate(path.c_str(), intact + (size - intact) / 2) == 0);
+
+	{
+		ClipStore store(100);
+		HistoryJournal journal(writer);
+		CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+		std::vector<std::string> expected = { "two", "one" };
+		CHECK(clips_of(store) == expected);
+		CHECK(file_size(path) == intact);
+
+		// Appending goes on after the last complete record
+		store.AddClip("four", "", "app", 4, 4);
+		journal.Close(5);
+		writer.Flush();
+	}
+
+	ClipStore store(100);
+	HistoryJournal journal(writer);
+	CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+	std::vector<std::string> expected = { "four", "two", "one" };
+	CHECK(clips_of(store) == expected);
+}
+
+
+static void
+test_damaged(const std::string& directory)
+{
+	std::string path = directory + "/damaged";
+	FileWriter writer;
+	off_t before;
+	off_t after;
+	{
+		ClipStore store(100);
+		HistoryJournal journal(writer);
+		journal.Create(path.c_str(), store);
+		store.AddClip("alpha", "", "app", 1, 1);
+		writer.Flush();
+		before = file_size(path);
+		store.AddClip("bravo", "", "app", 2, 2);
+		writer.Flush();
+		after = file_size(path);
+		store.AddClip("charlie", "", "app", 3, 3);
+		journal.Close(4);
+		writer.Flush();
+	}
+
+	// Flip a byte in the middle of the record that added "bravo"
+	std::string data = read_file(path);
+	CHECK(after > before && (size_t)after <= data.length());
+	data[(before + after) / 2] ^= 0xff;
+	write_file(path, data);
+
+	{
+		ClipStore store(100);
+		HistoryJournal journal(writer);
+		CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+		std::vector<std::string> expected = { "charlie", "alpha" };
+		CHECK(clips_of(store) == expected);
+		journal.Close(5);
+		writer.Flush();
+	}
+
+	// It was rewritten with what was left
+	CHECK(read_file(path) != data);
+	ClipStore store(100);
+	HistoryJournal journal(writer);
+	CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+	std::vector<std::string> expected = { "charlie", "alpha" };
+	CHECK(clips_of(store) == expected);
+}
+
+
+static void
+test_damaged_clip(const std::string& directory)
+{
+	std::string path = directory + "/damaged-clip";
+	FileWriter writer;
+	{
+		// Creating the journal snapshots the clips in one unchecked record
+		ClipStore store(100);
+		store.AddClip("alpha", "", "app", 1, 1);
+		store.AddClip("bravo", "", "app", 2, 2);
+		store.AddClip("charlie", "", "app", 3, 3);
+		HistoryJournal journal(writer);
+		journal.Create(path.c_str(), store);
+		journal.Close(4);
+		writer.Flush();
+	}
+
+	// Flip a byte of "bravo", which leaves every record intact
+	std::string data = read_file(path);
+	size_t found = data.find("bravo");
+	CHECK(found != std::string::npos);
+	if (found == std::string::npos)
+		return;
+	data[found + 2] ^= 0xff;
+	write_file(path, data);
+
+	{
+		ClipStore store(100);
+		HistoryJournal journal(writer);
+		CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+		std::vector<std::string> expected = { "charlie", "alpha" };
+		CHECK(clips_of(store) == expected);
+		journal.Close(5);
+		writer.Flush();
+	}
+
+	// It was rewritten without it
+	CHECK(read_file(path).find("bravo") == std::string::npos);
+	ClipStore store(100);
+	HistoryJournal journal(writer);
+	CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+	std::vector<std::string> expected = { "charlie", "alpha" };
+	CHECK(clips_of(store) == expected);
+}
+
+
+static void
+test_damaged_mapping(const std::string& directory)
+{
+	std::string path = directory + "/damaged-mapping";
+	FileWriter writer;
+	{
+		ClipStore store(100);
+		store.AddClip("alpha", "", "app", 1, 1);
+		store.AddClip("bravo", "", "app", 2, 2);
+		HistoryJournal journal(writer);
+		journal.Create(path.c_str(), store);
+		journal.Close(3);
+		writer.Flush();
+	}
+
+	ClipStore store(100);
+	HistoryJournal journal(writer);
+	CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+
+	// Damage "bravo" in place, under the clip that is mapped from it
+	std::string data = read_file(path);
+	size_t found = data.find("bravo");
+	CHECK(found != std::string::npos);
+	if (found == std::string::npos)
+		return;
+	FILE* file = fopen(path.c_str(), "r+b");
+	CHECK(file != NULL);
+	if (file == NULL)
+		return;
+	fseek(file, found + 2, SEEK_SET);
+	fputc('X', file);
+	fclose(file);
+
+	// Enough changes to have the journal compacted
+	ClipRecord* alpha = store.FindHash(store.ClipAt(1)->GetHash());
+	for (int32 i = 0; i < 300; i++)
+		store.SetTitle(alpha, i % 2 == 0 ? "odd" : "even");
+	journal.Close(4);
+	writer.Flush();
+
+	// The damaged clip wasn't carried over into the new snapshot
+	CHECK(read_file(path).find("brXvo") == std::string::npos);
+	ClipStore reopened(100);
+	HistoryJournal replayed(writer);
+	CHECK(replayed.Open(path.c_str(), reopened, NULL) == B_OK);
+	std::vector<std::string> expected = { "alpha" };
+	CHECK(clips_of(reopened) == expected);
+}
+
+
+static void
+test_blobs(const std::string& directory)
+{
+	std::string path = directory + "/blobs-journal";
+	std::string large(100, 'L');
+	BlobStore blobs;
+	CHECK(blobs.SetTo((directory + "/blobs").c_str(), 64) == B_OK);
+	{
+		// Written in the background, after the blob they refer to
+		FileWriter writer(60000000);
+		blobs.SetWriter(&writer);
+		ClipStore store(100);
+		store.SetBlobStore(&blobs);
+		HistoryJournal journal(writer);
+		journal.Create(path.c_str(), store);
+
+		store.AddClip(large, "", "app", 1, 1);
+		CHECK(store.ClipAt(0)->IsBlob());
+		CHECK(!blobs.Map(store.ClipAt(0)->GetHash()));
+		CHECK(clips_of(store)[0] == large);
+
+		// Once it's written, the clip is taken from the blob
+		writer.Flush();
+		store.AddClip("small", "", "app", 2, 2);
+		CHECK(blobs.Map(store.ClipAt(1)->GetHash()) != NULL);
+		CHECK(clips_of(store)[1] == large);
+		journal.Close(3);
+		writer.Flush();
+		blobs.SetWriter(NULL);
+	}
+
+	FileWriter writer;
+	ClipStore store(100);
+	store.SetBlobStore(&blobs);
+	HistoryJournal journal(writer);
+	CHECK(journal.Open(path.c_str(), store, NULL) == B_OK);
+	std::vector<std::string> expected = { "small", large };
+	CHECK(clips_of(store) == expected);
+	CHECK(store.CountClips() == 2 && store.ClipAt(1)->IsBlob());
+}
+
+
+static void
+test_unreadable(const std::string& directory)
+{
+	std::string path = directory + "/unreadable";
+	std::string data = "not a journal at all";
+	write_file(path, data);
+
+	FileWriter writer;
+	{
+		ClipStore store(100);
+		HistoryJournal journal(writer);
+		status_t status = journal.Open(path.c_str(), store, NULL);
+		CHECK(status != B_OK && status != B_ENTRY_NOT_FOUND);
+		CHECK(!journal.IsOpen());
+	}
+	writer.Flush();
+	CHECK(read_file(path) == data);
+}
+
+
+int
+main()
+{
+	std::string directory = make_test_directory("journal");
+	test_replay(directory);
+	test_missing(directory);
+	test_torn_tail(directory);
+	test_damaged(directory);
+	test_damaged_clip(directory);
+	test_damaged_mapping(directory);
+	test_blobs(directory);
+	test_unreadable(directory);
+	remove_test_directory(directory);
+	return check_result("journal_test");
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Saving and loading the trigram index: the ids are mapped on the way out
+ * and back in, an index that doesn't fit is refused, and a store whose
+ * clips got other ids than when it was saved finds the same clips.
+ */
+
+#include <vector>
+
+#include <string.h>
+
+#include "Check.h"
+#include "ClipStore.h"
+#include "TrigramIndex.h"
+
+
+static const uint64 kSignature = 0x1234567890abcdefULL;
+
+
+static void
+add(TrigramIndex& index, uint32 id, const char* text)
+{
+	index.Add(id, text, strlen(text));
+}
+
+
+static std::vector<uint32>
+find(const TrigramIndex& index, const char* query)
+{
+	std::vector<uint32> ids;
+	CHECK(index.Find(query, ids));
+	return ids;
+}
+
+
+static void
+test_remap(const std::string& directory)
+{
+	std::string path = directory + "/index";
+
+	TrigramIndex saved;
+	add(saved, 5, "Hello world");
+	add(saved, 9, "yellow");
+	add(saved, 12, "worldly");
+
+	// 12 isn't saved
+	std::unordered_map<uint32, uint32> saveIds = { { 5, 0 }, { 9, 1 } };
+	CHECK(saved.Save(path.c_str(), kSignature, saveIds) == B_OK);
+
+	TrigramIndex loaded;
+	std::vector<uint32> loadIds = { 200, 100 };
+	CHECK(loaded.Load(path.c_str(), kSignature, loadIds) == B_OK);
+
+	std::vector<uint32> expected = { 100, 200 };
+	CHECK(find(loaded, "llo") == expected);
+	expected = { 200 };
+	CHECK(find(loaded, "WORLD") == expected);
+	expected = { 100 };
+	CHECK(find(loaded, "yel") == expected);
+
+	// What's in memory doesn't change on the way out
+	expected = { 5, 12 };
+	CHECK(find(saved, "world") == expected);
+}
+
+
+static void
+test_refused(const std::string& directory)
+{
+	std::string path = directory + "/refused";
+
+	TrigramIndex saved;
+	add(saved, 0, "clipboard");
+	add(saved, 1, "history");
+	std::unordered_map<uint32, uint32> saveIds = { { 0, 0 }, { 1, 1 } };
+	CHECK(saved.Save(path.c_str(), kSignature, saveIds) == B_OK);
+
+	TrigramIndex loaded;
+	add(loaded, 7, "something else");
+	std::vector<uint32> loadIds = { 0, 1 };
+	CHECK(loaded.Load(path.c_str(), kSignature + 1, loadIds) == B_BAD_DATA);
+	CHECK(loaded.CountTrigrams() > 0);
+
+	// Saved ids beyond the clips there are now
+	loadIds.resize(1);
+	CHECK(loaded.Load(path.c_str(), kSignature, loadIds) == B_BAD_DATA);
+	CHECK(loaded.CountTrigrams() == 0);
+
+	CHECK(loaded.Load((directory + "/missing").c_str(), kSignature, loadIds)
+		== B_ENTRY_NOT_FOUND);
+}
+
+
+static void
+test_store(const std::string& directory)
+{
+	std::string path = directory + "/store";
+	const char* clips[] = { "the quick fox", "lazy dog", "quick brown dog" };
+
+	ClipStore saved(100);
+	for (int32 i = 0; i < 3; i++)
+		saved.AddClip(clips[i], "", "", i, i);
+	CHECK(saved.SaveIndex(path.c_str()) == B_OK);
+
+	// Like a history replayed after a clip came and went: the same clips,
+	// other ids
+	ClipStore loaded(100);
+	loaded.AddClip("gone", "", "", 0, 0);
+	loaded.RemoveClip(0);
+	loaded.SuspendIndex();
+	for (int32 i = 0; i < 3; i++)
+		loaded.AddClip(clips[i], "", "", i, i);
+	CHECK(loaded.ClipAt(0)->GetId() != saved.ClipAt(0)->GetId());
+	CHECK(loaded.LoadIndex(path.c_str()) == B_OK);
+
+	std::vector<int32> indexes;
+	std::vector<int32> expected = { 0, 2 };
+	CHECK(loaded.FindCandidates("quick", indexes));
+	CHECK(indexes == expected);
+	expected = { 0, 1 };
+	CHECK(loaded.FindCandidates("dog", indexes));
+	CHECK(indexes == expected);
+
+	// Other clips, it's rebuilt
+	ClipStore other(100);
+	other.SuspendIndex();
+	other.AddClip("lazy dog", "", "", 0, 0);
+	CHECK(other.LoadIndex(path.c_str()) == B_BAD_DATA);
+	expected = { 0 };
+	CHECK(other.FindCandidates("dog", indexes));
+	CHECK(indexes == expected);
+}
+
+
+int
+main()
+{
+	std::string directory = make_test_directory("trigram");
+	test_remap(directory);
+	test_refused(directory);
+	test_store(directory);
+	remove_test_directory(directory);
+	return check_result("trigram_test");
+}
@@ -11,15 +11,39 @@
 #include <AboutWindow.h>
 #include <Catalog.h>
 #include <Messenger.h>
+#include <PropertyInfo.h>
+
+#include <string.h>
 
 #include "App.h"
 #include "Constants.h"
+#include "Instrumentation.h"
+#include "Tracing.h"
 
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "Application"
 
 
+static property_info sProperties[] = {
+	{ "Counters", { B_GET_PROPERTY, B_SET_PROPERTY, B_DELETE_PROPERTY, 0 },
+		{ B_DIRECT_SPECIFIER, 0 },
+		"Allocation and copy counters of the clip hot paths (only counted "
+		"when built with INSTRUMENT=1). Get them as text, set a file to "
+		"write them to, or delete them to start over.",
+		0, { B_STRING_TYPE }
+	},
+	{ "Trace", { B_GET_PROPERTY, B_SET_PROPERTY, B_DELETE_PROPERTY, 0 },
+		{ B_DIRECT_SPECIFIER, 0 },
+		"Spans of startup and message handling as Chrome trace JSON (only "
+		"recorded when built with TRACE=1). Get them as text, set a file to "
+		"write them to, or delete them to start over.",
+		0, { B_STRING_TYPE }
+	},
+	{ 0 }
+};
+
+
 App::App()
 	:
 	BApplication(kApplicationSignature),
@@ -55,6 +79,9 @@ App::QuitRequested()
 void
 App::ReadyToRun()
 {
+	TRACE_THREAD("app");
+	TRACE_SPAN("App::ReadyToRun");
+
 	BRect rect = fSettings.GetWindowPosition();
 	fMainWindow = new MainWindow(rect);
 	fReplWindow = new ReplWindow(rect);
@@ -74,6 +101,8 @@ App::ReadyToRun()
 void
 App::MessageReceived(BMessage* msg)
 {
+	TRACE_MESSAGE("App::MessageReceived", msg->what);
+
 	switch (msg->what) {
 		case ACTIVATE:
 		{
@@ -106,6 +135,14 @@ App::MessageReceived(BMessage* msg)
 			}
 			break;
 		}
+		case B_GET_PROPERTY:
+		case B_SET_PROPERTY:
+		case B_DELETE_PROPERTY:
+		{
+			if (!_HandleScripting(msg))
+				BApplication::MessageReceived(msg);
+			break;
+		}
 		default:
 		{
 			BApplication::MessageReceived(msg);
@@ -115,6 +152,29 @@ App::MessageReceived(BMessage* msg)
 }
 
 
+BHandler*
+App::ResolveSpecifier(BMessage* msg, int32 index, BMessage* specifier,
+	int32 what, const char* property)
+{
+	BPropertyInfo propertyInfo(sProperties);
+	if (propertyInfo.FindMatch(msg, index, specifier, what, property) >= 0)
+		return this;
+
+	return BApplication::ResolveSpecifier(msg, index, specifier, what,
+		property);
+}
+
+
+status_t
+App::GetSupportedSuites(BMessage* data)
+{
+	data->AddString("suites", "suite/vnd.Humdinger-Clipdinger");
+	BPropertyInfo propertyInfo(sProperties);
+	data->AddFlat("messages", &propertyInfo);
+	return BApplication::GetSupportedSuites(data);
+}
+
+
 void
 App::AboutRequested()
 {
@@ -130,6 +190,48 @@ App::AboutRequested()
 }
 
 
+bool
+App::_HandleScripting(BMessage* msg)
+{
+	BMessage specifier;
+	int32 index;
+	int32 what;
+	const char* property;
+	if (msg->GetCurrentSpecifier(&index, &specifier, &what, &property) != B_OK)
+		return false;
+
+	bool trace = strcmp(property, "Trace") == 0;
+	if (!trace && strcmp(property, "Counters") != 0)
+		return false;
+
+	BMessage reply(B_REPLY);
+	status_t status = B_OK;
+	switch (msg->what) {
+		case B_GET_PROPERTY:
+			reply.AddString("result",
+				(trace ? trace_export() : instrument_report()).c_str());
+			break;
+		case B_SET_PROPERTY:
+		{
+			const char* path;
+			status = msg->FindString("data", &path);
+			if (status == B_OK)
+				status = trace ? trace_dump(path) : instrument_dump(path);
+			break;
+		}
+		case B_DELETE_PROPERTY:
+			if (trace)
+				trace_reset();
+			else
+				instrument_reset();
+			break;
+	}
+	reply.AddInt32("error", status);
+	msg->SendReply(&reply);
+	return true;
+}
+
+
 int
 main()
 {
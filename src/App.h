@@ -29,12 +29,18 @@ public:
 	virtual bool		QuitRequested();
 	void				AboutRequested();
 	void				MessageReceived(BMessage* msg);
+	virtual BHandler*	ResolveSpecifier(BMessage* msg, int32 index,
+							BMessage* specifier, int32 what,
+							const char* property);
+	virtual status_t	GetSupportedSuites(BMessage* data);
 
 	Settings*			GetSettings() { return &fSettings; }
 
 	MainWindow*			fMainWindow;
 
 private:
+	bool				_HandleScripting(BMessage* msg);
+
 	Settings			fSettings;
 	ReplWindow*			fReplWindow;
 	SettingsWindow*		fSettingsWindow;
@@ -7,66 +7,37 @@
  */
 
 #include <ControlLook.h>
-#include <Node.h>
-#include <NodeInfo.h>
 
-#include <stdio.h>
-
-#include "App.h"
 #include "ClipItem.h"
-#include "Constants.h"
 
 
-ClipItem::ClipItem(BString clip, BString title, BString path, bigtime_t added, bigtime_t since)
+ClipItem::ClipItem(const ClipRecord* record, IconCache& icons)
 	:
-	BListItem(),
-	fUpdateNeeded(true)
+	fRecord(record),
+	fDisplayWidth(-1),
+	fFadeLevel(0)
 {
-	fClip = clip;
-	fTitle = title;
-
-	if (title == "")
-		fDisplayTitle = fClip;
-	else
-		fDisplayTitle = fTitle;
-
-	fOrigin = path;
-	fTimeAdded = added;
-	fTimeSince = since;
 	fColor = ui_color(B_LIST_BACKGROUND_COLOR);
 
 	fIconSize = (int32(be_control_look->ComposeIconSize(16).Height()) + 1);
-	BEntry entry(path.String());
-	fOriginIcon = new BBitmap(BRect(0, 0, fIconSize - 1, fIconSize - 1), 0, B_RGBA32);
-
-	if (entry.InitCheck() == B_OK) {
-		entry_ref ref;
-		entry.GetRef(&ref);
-		BNodeInfo::GetTrackerIcon(&ref, fOriginIcon, icon_size(fIconSize));
-	} else {
-		BMimeType type("application/x-vnd.Be-elfexecutable");
-		status_t error = type.GetIcon(fOriginIcon, icon_size(fIconSize));
-		if (error != B_OK)
-			fOriginIcon = NULL;
-	}
+	fOriginIcon = icons.GetIcon(fRecord->GetOrigin().c_str(), fIconSize);
 }
 
 
 ClipItem::~ClipItem()
 {
-	delete fOriginIcon;
 }
 
 
 void
-ClipItem::DrawItem(BView* view, BRect rect, bool complete)
+ClipItem::DrawItem(BView* view, BRect rect, bool selected)
 {
 	static const float spacing = be_control_look->DefaultLabelSpacing();
 
 	// set background color
 	rgb_color bgColor;
 
-	if (IsSelected() && my_app->fMainWindow->GetHistoryActiveFlag())
+	if (selected)
 		bgColor = ui_color(B_LIST_SELECTED_BACKGROUND_COLOR);
 	else
 		bgColor = fColor;
@@ -75,26 +46,32 @@ ClipItem::DrawItem(BView* view, BRect rect, bool complete)
 	view->SetLowColor(bgColor);
 	view->FillRect(rect);
 
-	// icon of origin app
+	// icon of origin app, a placeholder until it's fetched
+	BPoint iconPoint(rect.left + spacing, rect.top + (rect.Height() - fIconSize) / 2);
 	if (fOriginIcon) {
 		view->SetDrawingMode(B_OP_OVER);
-		view->DrawBitmap(
-			fOriginIcon, BPoint(rect.left + spacing, rect.top + (rect.Height() - fIconSize) / 2));
+		view->DrawBitmap(fOriginIcon.get(), iconPoint);
 		view->SetDrawingMode(B_OP_COPY);
-	} else
-		printf("Found no icon\n");
+	} else {
+		BRect iconRect(iconPoint, iconPoint + BPoint(fIconSize - 1, fIconSize - 1));
+		float tint = bgColor.IsDark() ? B_LIGHTEN_1_TINT : B_DARKEN_1_TINT;
+		view->SetHighColor(tint_color(bgColor, tint));
+		view->FillRoundRect(iconRect.InsetByCopy(2, 2), 2, 2);
+	}
 
 	// text
-	if (IsSelected() && my_app->fMainWindow->GetHistoryActiveFlag())
+	if (selected)
 		view->SetHighUIColor(B_LIST_SELECTED_ITEM_TEXT_COLOR);
 	else
 		view->SetHighUIColor(B_LIST_ITEM_TEXT_COLOR);
 
-	if (fUpdateNeeded) {
-		BString title(GetTitle());
-		view->TruncateString(&title, B_TRUNCATE_END, Width() - fIconSize - spacing * 4);
+	// Truncated again when the width changed, only visible clips get read
+	if (fDisplayWidth != rect.Width()) {
+		BString title(_DisplayText());
+		view->TruncateString(&title, B_TRUNCATE_END,
+			rect.Width() - fIconSize - spacing * 4);
 		fDisplayTitle = title;
-		fUpdateNeeded = false;
+		fDisplayWidth = rect.Width();
 	}
 
 	BFont font;
@@ -103,51 +80,26 @@ ClipItem::DrawItem(BView* view, BRect rect, bool complete)
 	font.GetHeight(&fheight);
 
 	view->DrawString(fDisplayTitle.String(),
-		BPoint(fIconSize - 1 + spacing * 3,
+		BPoint(rect.left + fIconSize - 1 + spacing * 3,
 			rect.top + fheight.ascent + fheight.descent + fheight.leading));
 
 	// draw lines
 	float tint = ui_color(B_LIST_BACKGROUND_COLOR).IsDark() ? B_LIGHTEN_1_TINT : B_DARKEN_1_TINT;
 	view->SetHighColor(tint_color(ui_color(B_LIST_BACKGROUND_COLOR), tint));
 	view->StrokeLine(rect.LeftBottom(), rect.RightBottom());
-	view->StrokeLine(BPoint(fIconSize - 1 + spacing * 2, rect.top),
-		BPoint(fIconSize - 1 + spacing * 2, rect.bottom));
-}
-
-
-void
-ClipItem::Update(BView* view, const BFont* finfo)
-{
-	// we need to DefaultLabelSpacing the update method so we can make sure the
-	// list item size doesn't change
-	BListItem::Update(view, finfo);
-
-	static const float spacing = be_control_look->DefaultLabelSpacing();
-	BString title(GetTitle());
-	view->TruncateString(&title, B_TRUNCATE_END, Width() - fIconSize - spacing * 4);
-	fDisplayTitle = title;
-
-	font_height fheight;
-	finfo->GetHeight(&fheight);
-
-	SetHeight(ceilf(fheight.ascent + 2 + fheight.leading / 2 + fheight.descent) + 5);
+	view->StrokeLine(BPoint(rect.left + fIconSize - 1 + spacing * 2, rect.top),
+		BPoint(rect.left + fIconSize - 1 + spacing * 2, rect.bottom));
 }
 
 
 BString
-ClipItem::GetTitle()
+ClipItem::_DisplayText()
 {
-	return ((fTitle == "") ? fClip : fTitle);
-}
-
-
-void
-ClipItem::SetTitle(BString title, bool update)
-{
-	if (title == fClip)
-		fTitle = "";
-	else
-		fTitle = (title == "") ? fClip : title;
+	if (fRecord->HasTitle()) {
+		const std::string& title = fRecord->GetTitle();
+		return BString(title.c_str(), title.length());
+	}
 
-	fUpdateNeeded = update;
+	// Large clips don't have to be paged in to show their start
+	return BString(fRecord->GetPreviewData(), fRecord->GetPreviewLength());
 }
@@ -12,43 +12,46 @@
 #include <Bitmap.h>
 #include <Font.h>
 #include <InterfaceDefs.h>
-#include <ListItem.h>
 #include <String.h>
+#include <View.h>
 
+#include "ClipStore.h"
+#include "IconCache.h"
 
-class ClipItem : public BListItem {
+
+// What the ClipView displays of a clip. Only the rows in view have one.
+class ClipItem {
 public:
-					ClipItem(BString clip, BString title, BString path,
-						bigtime_t added, bigtime_t since);
+					ClipItem(const ClipRecord* record, IconCache& icons);
 					~ClipItem();
 
-	virtual void	DrawItem(BView* view, BRect rect, bool complete = false);
-	virtual	void	Update(BView* view, const BFont* finfo);
+	void			DrawItem(BView* view, BRect rect, bool selected);
+
+	const ClipRecord* GetRecord() { return fRecord; };
 
-	BString			GetClip() { return fClip; };
-	BString			GetOrigin() { return fOrigin; };
+	// Set the title through the ClipStore, then update the display
+	void			TitleChanged() { fDisplayWidth = -1; };
 
-	BString			GetTitle();
-	void			SetTitle(BString title, bool update = false);
+	// Set by the ClipView before the item is drawn
+	int32			FadeLevel() { return fFadeLevel; };
+	void			SetFade(int32 level, rgb_color color)
+						{ fFadeLevel = level; fColor = color; };
 
-	bigtime_t		GetTimeAdded() { return fTimeAdded; };
-	void			SetTimeAdded(bigtime_t added) { fTimeAdded = added; };
-	bigtime_t		GetTimeSince() { return fTimeSince; };
-	void			SetTimeSince(bigtime_t since) { fTimeSince = since; };
-	void			SetColor(rgb_color color) { fColor = color; };
+	// NULL until the IconCache fetched it
+	void			SetIcon(const IconRef& icon) { fOriginIcon = icon; };
+	int32			IconSize() { return fIconSize; };
 
 private:
-	BString			fClip;			// The actual clip, never touch!
-	BString			fTitle;			// The optional user title.
+	BString			_DisplayText();
+
+	const ClipRecord* fRecord;		// Owned by the MainWindow's ClipStore
 	BString			fDisplayTitle;	// What's actually displayed
-	bool			fUpdateNeeded;
+	float			fDisplayWidth;	// it's truncated to, -1 to redo it
 
-	BString			fOrigin;
-	BBitmap*		fOriginIcon;
+	IconRef			fOriginIcon;	// Shared with other clips of the app
 	int32			fIconSize;
-	bigtime_t		fTimeAdded;
-	bigtime_t		fTimeSince;
 
+	int32			fFadeLevel;
 	rgb_color		fColor;
 };
 
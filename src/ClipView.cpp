@@ -6,45 +6,74 @@
  *	Humdinger, humdingerb@gmail.com
  */
 
+#include <Bitmap.h>
 #include <Catalog.h>
 #include <ControlLook.h>
 #include <DateFormat.h>
+#include <LayoutUtils.h>
+#include <ScrollBar.h>
 #include <TimeFormat.h>
 #include <ToolTip.h>
 
+#include <algorithm>
+
+#include <math.h>
+
 #include "App.h"
 #include "ClipItem.h"
 #include "ClipView.h"
 #include "Constants.h"
 #include "ContextPopUp.h"
 #include "MainWindow.h"
+#include "Tracing.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "ClipList"
 
 
-ClipView::ClipView(const char* name)
+ClipView::ClipView(const char* name, const ClipStore& store,
+	IconCache& icons)
 	:
-	BListView(name),
-	fShowingPopUpMenu(false)
+	BView(name, B_WILL_DRAW | B_FRAME_EVENTS | B_FULL_UPDATE_ON_RESIZE
+		| B_NAVIGABLE),
+	fStore(store),
+	fIcons(icons),
+	fFiltered(false),
+	fLayout(kHistoryOverscan),
+	fSelection(-1),
+	fShowingPopUpMenu(false),
+	fDragIndex(-1),
+	fFadeTime(0),
+	fFadePaused(false),
+	fNextFade(0),
+	fRunner(NULL)
 {
+	fFadeColors.push_back(ui_color(B_LIST_BACKGROUND_COLOR));
 }
 
 
 ClipView::~ClipView()
 {
+	delete fRunner;
 }
 
 
 void
 ClipView::AttachedToWindow()
 {
-	SetFlags(Flags() | B_FULL_UPDATE_ON_RESIZE | B_NAVIGABLE);
+	BView::AttachedToWindow();
 
-	BMessage message(ADJUSTCOLORS);
-	fRunner = new BMessageRunner(this, &message, kMinuteUnits * 60000000);
+	// All rows have the height a BListView would give a ClipItem
+	font_height fheight;
+	GetFontHeight(&fheight);
+	fLayout.SetRowHeight(
+		ceilf(fheight.ascent + 2 + fheight.leading / 2 + fheight.descent) + 5);
 
-	BListView::AttachedToWindow();
+	if (!Messenger().IsValid())
+		SetTarget(Window());
+
+	_RowsChanged();
+	AdjustColors();
 }
 
 
@@ -54,68 +83,65 @@ ClipView::Draw(BRect rect)
 	SetHighColor(ui_color(B_CONTROL_BACKGROUND_COLOR));
 
 	BRect bounds(Bounds());
-	BRect itemFrame = ItemFrame(CountItems() - 1);
-	bounds.top = itemFrame.bottom;
-	FillRect(bounds);
+	bounds.top = fLayout.Height();
+	if (bounds.IsValid())
+		FillRect(bounds & rect);
+
+	// Only the items that get drawn need their fade level. The ones that
+	// were scrolled into view may be due before the others.
+	int32 first;
+	int32 last;
+	if (!_VisibleItems(rect, first, last))
+		return;
 
-	BListView::Draw(rect);
+	bool active = my_app->fMainWindow->GetHistoryActiveFlag();
+	bigtime_t next = 0;
+	for (int32 i = first; i <= last; i++) {
+		ClipItem* item = _ItemAt(i);
+		int32 level = _FadeLevel(item);
+		item->SetFade(level, fFadeColors[level]);
+		item->DrawItem(this, RowFrame(i), active && i == fSelection);
+
+		bigtime_t when = _NextFade(item);
+		if (when != 0 && (next == 0 || when < next))
+			next = when;
+	}
+	if (next != 0 && (fNextFade == 0 || next < fNextFade))
+		_ScheduleFading(next);
 }
 
 
-bool
-ClipView::InitiateDrag(BPoint point, int32 dragIndex, bool wasSelected)
+void
+ClipView::FrameResized(float width, float height)
 {
-	BPoint pt;
-	uint32 buttons;
-	GetMouse(&pt, &buttons);
-
-	if ((buttons & B_SECONDARY_MOUSE_BUTTON) != 0)
-		return false;
-
-	ClipItem* sItem = dynamic_cast<ClipItem*>(ItemAt(CurrentSelection()));
-	if (sItem == NULL) {
-		// workaround for a timing problem (see Locale prefs)
-		sItem = dynamic_cast<ClipItem*>(ItemAt(dragIndex));
-		Select(dragIndex);
-		if (sItem == NULL)
-			return false;
-	}
-	BString string(sItem->GetClip());
-	BMessage message(B_SIMPLE_DATA);
-	message.AddData("text/plain", B_MIME_TYPE, string, string.Length());
-	message.AddInt32("clipdinger_command", FAV_ADD);
-
-	BRect dragRect(0.0f, 0.0f, Bounds().Width(), sItem->Height());
-	BBitmap* dragBitmap = new BBitmap(dragRect, B_RGB32, true);
-	if (dragBitmap->IsValid()) {
-		BView* view = new BView(dragBitmap->Bounds(), "helper", B_FOLLOW_NONE, B_WILL_DRAW);
-		dragBitmap->AddChild(view);
-		dragBitmap->Lock();
+	BView::FrameResized(width, height);
 
-		sItem->DrawItem(view, dragRect);
-		view->SetHighColor(0, 0, 0, 255);
-		view->StrokeRect(view->Bounds());
-		view->Sync();
+	_UpdateScrollBar();
+	_TrimItems();
+}
 
-		dragBitmap->Unlock();
-	} else {
-		delete dragBitmap;
-		dragBitmap = NULL;
-	}
 
-	if (dragBitmap != NULL)
-		DragMessage(&message, dragBitmap, B_OP_ALPHA, BPoint(0.0, 0.0));
-	else
-		DragMessage(&message, dragRect.OffsetToCopy(point), this);
-
-	return true;
+status_t
+ClipView::Invoke(BMessage* message)
+{
+	if (message == NULL)
+		message = Message();
+	if (message == NULL)
+		return B_BAD_VALUE;
+
+	// What a BListView sends
+	BMessage clone(*message);
+	clone.AddInt64("when", system_time());
+	clone.AddPointer("source", this);
+	clone.AddInt32("index", fSelection);
+	return BInvoker::Invoke(&clone);
 }
 
 
 void
 ClipView::MakeFocus(bool focused)
 {
-	BListView::MakeFocus(focused);
+	BView::MakeFocus(focused);
 
 	// only signal ClipView is focused when gaining focus
 	if (focused)
@@ -126,6 +152,8 @@ ClipView::MakeFocus(bool focused)
 void
 ClipView::MessageReceived(BMessage* message)
 {
+	TRACE_MESSAGE("ClipView::MessageReceived", message->what);
+
 	switch (message->what) {
 		case POPCLOSED:
 		{
@@ -135,12 +163,17 @@ ClipView::MessageReceived(BMessage* message)
 		case ADJUSTCOLORS:
 		{
 			AdjustColors();
-			Invalidate();
+			break;
+		}
+		case FADE_ITEMS:
+		{
+			fNextFade = 0;
+			UpdateFading();
 			break;
 		}
 		default:
 		{
-			BListView::MessageReceived(message);
+			BView::MessageReceived(message);
 			break;
 		}
 	}
@@ -150,6 +183,9 @@ ClipView::MessageReceived(BMessage* message)
 void
 ClipView::KeyDown(const char* bytes, int32 numBytes)
 {
+	int32 count = CountRows();
+	int32 page = (int32)(Bounds().Height() / fLayout.RowHeight());
+
 	switch (bytes[0]) {
 		case B_DELETE:
 		{
@@ -165,9 +201,44 @@ ClipView::KeyDown(const char* bytes, int32 numBytes)
 			}
 			break;
 		}
+		case B_UP_ARROW:
+		case B_DOWN_ARROW:
+		case B_PAGE_UP:
+		case B_PAGE_DOWN:
+		case B_HOME:
+		case B_END:
+		{
+			if (count == 0)
+				break;
+
+			int32 index = fSelection;
+			if (bytes[0] == B_UP_ARROW)
+				index = index < 0 ? count - 1 : index - 1;
+			else if (bytes[0] == B_DOWN_ARROW)
+				index++;
+			else if (bytes[0] == B_PAGE_UP)
+				index -= std::max(page, (int32)1);
+			else if (bytes[0] == B_PAGE_DOWN)
+				index += std::max(page, (int32)1);
+			else if (bytes[0] == B_HOME)
+				index = 0;
+			else
+				index = count - 1;
+
+			Select(std::max((int32)0, std::min(index, count - 1)));
+			ScrollToSelection();
+			break;
+		}
+		case B_ENTER:
+		case B_SPACE:
+		{
+			if (fSelection >= 0)
+				Invoke();
+			break;
+		}
 		default:
 		{
-			BListView::KeyDown(bytes, numBytes);
+			BView::KeyDown(bytes, numBytes);
 			break;
 		}
 	}
@@ -179,43 +250,91 @@ ClipView::MouseDown(BPoint position)
 {
 	MakeFocus(true);
 
-	BRect bounds(Bounds());
-	BRect itemFrame = ItemFrame(CountItems() - 1);
-	bounds.top = itemFrame.bottom;
-	if (bounds.Contains(position))
+	int32 index = IndexOf(position);
+	if (index < 0)
 		return;
 
 	uint32 buttons = 0;
-	if (Window() != NULL && Window()->CurrentMessage() != NULL)
+	int32 clicks = 1;
+	if (Window() != NULL && Window()->CurrentMessage() != NULL) {
 		buttons = Window()->CurrentMessage()->FindInt32("buttons");
+		clicks = Window()->CurrentMessage()->FindInt32("clicks");
+	}
 
 	if ((buttons & B_SECONDARY_MOUSE_BUTTON) != 0) {
-		Select(IndexOf(position));
+		Select(index);
 		_ShowPopUpMenu(ConvertToScreen(position));
 		return;
 	}
-	BListView::MouseDown(position);
+
+	if (clicks == 2 && index == fSelection) {
+		Invoke();
+		return;
+	}
+
+	Select(index);
+	fDragIndex = index;
+	fDragStart = position;
+	SetMouseEventMask(B_POINTER_EVENTS, B_NO_POINTER_HISTORY);
+}
+
+
+void
+ClipView::MouseMoved(BPoint where, uint32 transit,
+	const BMessage* dragMessage)
+{
+	if (fDragIndex >= 0 && (fabs(where.x - fDragStart.x) > 4
+			|| fabs(where.y - fDragStart.y) > 4)) {
+		int32 index = fDragIndex;
+		fDragIndex = -1;
+		_InitiateDrag(where, index);
+	}
+	BView::MouseMoved(where, transit, dragMessage);
+}
+
+
+void
+ClipView::MouseUp(BPoint position)
+{
+	fDragIndex = -1;
+	BView::MouseUp(position);
+}
+
+
+void
+ClipView::ScrollTo(BPoint where)
+{
+	BView::ScrollTo(where);
+	_TrimItems();
+}
+
+
+BSize
+ClipView::MinSize()
+{
+	return BLayoutUtils::ComposeSize(ExplicitMinSize(),
+		BSize(10 * fLayout.RowHeight(), fLayout.RowHeight()));
 }
 
 
 bool
 ClipView::GetToolTipAt(BPoint point, BToolTip** _tip)
 {
-	ClipItem* item = static_cast<ClipItem*>(this->ItemAt(this->IndexOf(point)));
-	if (item == NULL)
+	ClipRecord* record = RowAt(IndexOf(point));
+	if (record == NULL)
 		return false;
 
 	BString dateString = "";
-	bigtime_t added = item->GetTimeAdded();
+	bigtime_t added = record->GetTimeAdded();
 	if (BDateFormat().Format(dateString, added, B_MEDIUM_DATE_FORMAT) != B_OK)
 		return false;
 
 	BString timeString = "";
-	added = item->GetTimeAdded();
+	added = record->GetTimeAdded();
 	if (BTimeFormat().Format(timeString, added, B_SHORT_TIME_FORMAT) != B_OK)
 		return false;
 
-	BString clipString(item->GetClip());
+	BString clipString(record->GetPreviewData(), record->GetPreviewLength());
 	// Add ellipsis if text length is > 300 chars
 	if (clipString.Length() > 300) {
 		clipString.Truncate(300);
@@ -238,6 +357,126 @@ ClipView::GetToolTipAt(BPoint point, BToolTip** _tip)
 }
 
 
+// #pragma mark - Rows
+
+
+int32
+ClipView::CountRows() const
+{
+	return fFiltered ? (int32)fShown.size() : fStore.CountClips();
+}
+
+
+ClipRecord*
+ClipView::RowAt(int32 index) const
+{
+	if (index < 0 || index >= CountRows())
+		return NULL;
+	return fStore.ClipAt(fFiltered ? fShown[index] : index);
+}
+
+
+void
+ClipView::ClipsChanged()
+{
+	// Ids start over with an empty store, so must the items
+	if (fStore.IsEmpty())
+		fItems.MakeEmpty();
+
+	if (fSelection >= CountRows())
+		fSelection = CountRows() - 1;
+	_RowsChanged();
+}
+
+
+void
+ClipView::ShowOnly(const std::vector<int32>& indexes)
+{
+	// Items of clips that are still shown are kept
+	fShown = indexes;
+	fFiltered = true;
+	fSelection = -1;
+	_RowsChanged();
+}
+
+
+void
+ClipView::ShowAll()
+{
+	fShown.clear();
+	fFiltered = false;
+	fSelection = -1;
+	_RowsChanged();
+}
+
+
+void
+ClipView::RowChanged(int32 index)
+{
+	ClipRecord* record = RowAt(index);
+	if (record == NULL)
+		return;
+
+	ClipItem* item = fItems.Get(record->GetId());
+	if (item != NULL)
+		item->TitleChanged();
+	InvalidateRow(index);
+}
+
+
+void
+ClipView::Select(int32 index)
+{
+	if (index < 0 || index >= CountRows())
+		index = -1;
+	if (index == fSelection)
+		return;
+
+	InvalidateRow(fSelection);
+	fSelection = index;
+	InvalidateRow(fSelection);
+}
+
+
+void
+ClipView::ScrollToSelection()
+{
+	if (fSelection < 0)
+		return;
+
+	BRect frame(RowFrame(fSelection));
+	BRect bounds(Bounds());
+	if (frame.top < bounds.top)
+		ScrollTo(BPoint(bounds.left, frame.top));
+	else if (frame.bottom > bounds.bottom)
+		ScrollTo(BPoint(bounds.left, frame.bottom - bounds.Height()));
+}
+
+
+int32
+ClipView::IndexOf(BPoint point) const
+{
+	return fLayout.RowAt(point.y);
+}
+
+
+BRect
+ClipView::RowFrame(int32 index) const
+{
+	BRect bounds(Bounds());
+	return BRect(bounds.left, fLayout.RowTop(index), bounds.right,
+		fLayout.RowBottom(index));
+}
+
+
+void
+ClipView::InvalidateRow(int32 index)
+{
+	if (index >= 0 && index < CountRows())
+		Invalidate(RowFrame(index));
+}
+
+
 // #pragma mark - Member Functions
 
 
@@ -260,31 +499,89 @@ ClipView::AdjustColors()
 		settings->Unlock();
 	}
 
-	if (pause)
+	// An item fades a level every 'delay' minutes, until it reaches
+	// 'maxlevel' after 'step' levels
+	rgb_color background = ui_color(B_LIST_BACKGROUND_COLOR);
+	bool isdark = background.IsDark();
+	fFade.SetTo((bigtime_t)delay * 60, fade ? step : 0);
+	int32 steps = fFade.CountSteps();
+	fFadeColors.clear();
+	for (int32 i = 0; i <= steps; i++) {
+		float level = B_NO_TINT;
+		if (steps > 0)
+			level += (maxlevel - B_NO_TINT) * i / steps;
+		if (isdark)
+			level = 1 + (1 - level); // if backround is dark, lighten instead of darken
+		fFadeColors.push_back(tint_color(background, level));
+	}
+
+	fFadePaused = pause;
+	if (!fFadePaused || fFadeTime == 0)
+		fFadeTime = real_time_clock();
+
+	// Levels are worked out again when the items are drawn
+	fNextFade = 0;
+	_ScheduleFading(0);
+	Invalidate();
+}
+
+
+void
+ClipView::UpdateFading()
+{
+	if (fFade.CountSteps() == 0 || fFadePaused)
 		return;
 
-	bool isdark = ui_color(B_LIST_BACKGROUND_COLOR).IsDark();
-	bool reachedmax = false;
-	bigtime_t now(real_time_clock());
-
-	for (int32 i = 0; i < CountItems(); i++) {
-		ClipItem* sItem = dynamic_cast<ClipItem*>(ItemAt(i));
-		if (fade) {
-			float level = 0;
-			if (!reachedmax) {
-				bigtime_t minutes = (now - sItem->GetTimeSince()) / 60;
-				level = B_NO_TINT + (maxlevel / step * ((float) minutes / delay) / kMinuteUnits);
-				if (level > maxlevel) {
-					reachedmax = true;
-					level = maxlevel;
-				}
-			} else
-				level = maxlevel;
-			if (isdark)
-				level = 1 + (1 - level); // if backround is dark, lighten instead of darken
-			sItem->SetColor(tint_color(ui_color(B_LIST_BACKGROUND_COLOR), level)); 
-		} else
-			sItem->SetColor(ui_color(B_LIST_BACKGROUND_COLOR));
+	fFadeTime = real_time_clock();
+
+	int32 first;
+	int32 last;
+	if (!_VisibleItems(Bounds(), first, last)) {
+		_ScheduleFading(0);
+		return;
+	}
+
+	bigtime_t next = 0;
+	for (int32 i = first; i <= last; i++) {
+		ClipItem* item = _ItemAt(i);
+		int32 level = _FadeLevel(item);
+		if (level != item->FadeLevel()) {
+			item->SetFade(level, fFadeColors[level]);
+			InvalidateRow(i);
+		}
+
+		bigtime_t when = _NextFade(item);
+		if (when != 0 && (next == 0 || when < next))
+			next = when;
+	}
+	_ScheduleFading(next);
+}
+
+
+void
+ClipView::UpdateIcons(const char* path, int32 size)
+{
+	// The other rows get the icon from the IconCache once they're shown
+	IconRef icon = fIcons.GetIcon(path, size);
+	std::vector<uint32> changed;
+	fItems.ForEach([&](uint32 id, ClipItem* item) {
+		if (item->IconSize() == size
+			&& item->GetRecord()->GetOrigin() == path) {
+			item->SetIcon(icon);
+			changed.push_back(id);
+		}
+	});
+	if (changed.empty())
+		return;
+
+	int32 first;
+	int32 last;
+	if (!_VisibleItems(Bounds(), first, last))
+		return;
+	for (int32 i = first; i <= last; i++) {
+		if (std::find(changed.begin(), changed.end(), RowAt(i)->GetId())
+				!= changed.end())
+			InvalidateRow(i);
 	}
 }
 
@@ -319,3 +616,160 @@ ClipView::_ShowPopUpMenu(BPoint screen)
 	menu->Go(screen, true, true, true);
 	fShowingPopUpMenu = true;
 }
+
+
+void
+ClipView::_InitiateDrag(BPoint point, int32 index)
+{
+	ClipRecord* record = RowAt(index);
+	if (record == NULL)
+		return;
+
+	BMessage message(B_SIMPLE_DATA);
+	message.AddData("text/plain", B_MIME_TYPE, record->GetClipData(),
+		record->GetClipLength());
+	message.AddInt32("clipdinger_command", FAV_ADD);
+
+	BRect dragRect(0.0f, 0.0f, Bounds().Width(), fLayout.RowHeight() - 1);
+	BBitmap* dragBitmap = new BBitmap(dragRect, B_RGB32, true);
+	if (dragBitmap->IsValid()) {
+		BView* view = new BView(dragBitmap->Bounds(), "helper", B_FOLLOW_NONE, B_WILL_DRAW);
+		dragBitmap->AddChild(view);
+		dragBitmap->Lock();
+
+		_ItemAt(index)->DrawItem(view, dragRect, false);
+		view->SetHighColor(0, 0, 0, 255);
+		view->StrokeRect(view->Bounds());
+		view->Sync();
+
+		dragBitmap->Unlock();
+	} else {
+		delete dragBitmap;
+		dragBitmap = NULL;
+	}
+
+	BPoint offset(point.x, point.y - fLayout.RowTop(index));
+	if (dragBitmap != NULL)
+		DragMessage(&message, dragBitmap, B_OP_ALPHA, offset);
+	else
+		DragMessage(&message, dragRect.OffsetToCopy(point - offset), this);
+}
+
+
+ClipItem*
+ClipView::_ItemAt(int32 index)
+{
+	// After MergeOlder() an id may belong to another clip
+	ClipRecord* record = RowAt(index);
+	ClipItem* item = fItems.Get(record->GetId());
+	if (item == NULL || item->GetRecord() != record) {
+		item = new ClipItem(record, fIcons);
+		fItems.Put(record->GetId(), item);
+	}
+	return item;
+}
+
+
+void
+ClipView::_RowsChanged()
+{
+	fLayout.SetCount(CountRows());
+	_UpdateScrollBar();
+	_TrimItems();
+	Invalidate();
+}
+
+
+void
+ClipView::_TrimItems()
+{
+	// Only the items of the rows around the visible ones are kept, so
+	// none is left of a removed clip
+	BRect bounds(Bounds());
+	int32 first;
+	int32 last;
+	if (fLayout.RowsAround(bounds.top, bounds.bottom, first, last)) {
+		for (int32 i = first; i <= last; i++) {
+			ClipRecord* record = RowAt(i);
+			if (record == NULL)
+				break;
+			ClipItem* item = fItems.Get(record->GetId());
+			if (item != NULL && item->GetRecord() == record)
+				fItems.Retain(record->GetId());
+		}
+	}
+	fItems.Trim();
+}
+
+
+void
+ClipView::_UpdateScrollBar()
+{
+	BScrollBar* scrollBar = ScrollBar(B_VERTICAL);
+	if (scrollBar == NULL)
+		return;
+
+	// Like BListView::FixupScrollBar()
+	BRect bounds(Bounds());
+	float height = fLayout.Height();
+	if (bounds.Height() > height) {
+		scrollBar->SetRange(0.0, 0.0);
+		scrollBar->SetValue(0.0);
+	} else {
+		scrollBar->SetRange(0.0, height - bounds.Height() - 1.0);
+		scrollBar->SetProportion(bounds.Height() / height);
+		// scroll up if there is empty room on bottom
+		if (height - 1 < bounds.bottom)
+			ScrollBy(0.0, height - 1 - bounds.bottom);
+	}
+	scrollBar->SetSteps(fLayout.RowHeight(), bounds.Height());
+}
+
+
+bool
+ClipView::_VisibleItems(BRect rect, int32& first, int32& last)
+{
+	// Until ClipsChanged() the layout may still count removed clips
+	rect = rect & Bounds();
+	if (!rect.IsValid()
+		|| !fLayout.RowsIn(rect.top, rect.bottom, first, last))
+		return false;
+	last = std::min(last, CountRows() - 1);
+	return first <= last;
+}
+
+
+int32
+ClipView::_FadeLevel(ClipItem* item)
+{
+	return fFade.LevelAt(item->GetRecord()->GetTimeSince(), fFadeTime);
+}
+
+
+bigtime_t
+ClipView::_NextFade(ClipItem* item)
+{
+	if (fFadePaused)
+		return 0;
+	return fFade.NextChange(item->GetRecord()->GetTimeSince(), fFadeTime);
+}
+
+
+void
+ClipView::_ScheduleFading(bigtime_t when)
+{
+	if (when == fNextFade && (when == 0) == (fRunner == NULL))
+		return;
+
+	delete fRunner;
+	fRunner = NULL;
+	fNextFade = when;
+	if (when == 0)
+		return;
+
+	// real_time_clock() counts seconds
+	bigtime_t delay = std::max((bigtime_t)1, when - real_time_clock());
+	BMessage message(FADE_ITEMS);
+	fRunner = new BMessageRunner(BMessenger(this), &message, delay * 1000000,
+		1);
+}
@@ -9,34 +9,113 @@
 #ifndef CLIPVIEW_H
 #define CLIPVIEW_H
 
-#include <ListView.h>
+#include <Invoker.h>
 #include <MenuItem.h>
 #include <MessageRunner.h>
+#include <View.h>
 
+#include <vector>
 
-class ClipView : public BListView {
+#include "ClipStore.h"
+#include "FadeSchedule.h"
+#include "IconCache.h"
+#include "VisibleRows.h"
+
+class ClipItem;
+
+
+// The history list. It shows the clips of the ClipStore, a row each, or
+// only the matches while filtering. Only the rows in view get a ClipItem
+// to display them. That way it takes the same to scroll or filter however
+// long the history is.
+class ClipView : public BView, public BInvoker {
 public:
-					ClipView(const char* name);
+					ClipView(const char* name, const ClipStore& store,
+						IconCache& icons);
 					~ClipView();
 
 	virtual void	AttachedToWindow();
 	virtual void	Draw(BRect rect);
-	virtual bool	InitiateDrag(BPoint point, int32 index,
-						bool wasSelected);
+	virtual	void	FrameResized(float width, float height);
+	virtual	status_t Invoke(BMessage* message = NULL);
 	virtual	void	MakeFocus(bool focused = true);
 	virtual	void	MessageReceived(BMessage* message);
 	virtual	void	KeyDown(const char* bytes, int32 numBytes);
-	void			MouseDown(BPoint position);
+	virtual	void	MouseDown(BPoint position);
+	virtual	void	MouseMoved(BPoint where, uint32 transit,
+						const BMessage* dragMessage);
+	virtual	void	MouseUp(BPoint position);
+	virtual	void	ScrollTo(BPoint where);
+	virtual	BSize	MinSize();
+
+	// The rows, by index like a BListView
+	int32			CountRows() const;
+	bool			IsEmpty() const { return CountRows() == 0; }
+	ClipRecord*		RowAt(int32 index) const;
+
+	// Has to be called when clips were added or removed. While filtering
+	// the store indexes are stale, call ShowOnly() with the new ones.
+	void			ClipsChanged();
+	// Only shows the clips at these store indexes, in that order
+	void			ShowOnly(const std::vector<int32>& indexes);
+	void			ShowAll();
+	bool			IsFiltered() const { return fFiltered; }
+	// E.g. after its title changed
+	void			RowChanged(int32 index);
+
+	int32			CurrentSelection() const { return fSelection; }
+	void			Select(int32 index);
+	void			DeselectAll() { Select(-1); }
+	void			ScrollToSelection();
 
+	// -1 if there's no row at 'point'
+	int32			IndexOf(BPoint point) const;
+	BRect			RowFrame(int32 index) const;
+	void			InvalidateRow(int32 index);
+
+	// Takes over changed fade settings or colors
 	void			AdjustColors();
+	// Fades the visible items that are due
+	void			UpdateFading();
+	// The IconCache fetched the icon of an origin
+	void			UpdateIcons(const char* path, int32 size);
 
 protected:
 	virtual	bool	GetToolTipAt(BPoint point, BToolTip** _tip);
 
 private:
 	void			_ShowPopUpMenu(BPoint screen);
+	void			_InitiateDrag(BPoint point, int32 index);
+
+	ClipItem*		_ItemAt(int32 index);
+	void			_RowsChanged();
+	void			_TrimItems();
+	void			_UpdateScrollBar();
+
+	bool			_VisibleItems(BRect rect, int32& first, int32& last);
+	int32			_FadeLevel(ClipItem* item);
+	bigtime_t		_NextFade(ClipItem* item);
+	void			_ScheduleFading(bigtime_t when);
+
+	const ClipStore& fStore;
+	IconCache&		fIcons;
+	bool			fFiltered;
+	std::vector<int32> fShown;			// Store indexes while filtering
+	VisibleRows		fLayout;
+	RowCache<uint32, ClipItem> fItems;	// Of the rows around, by clip id
+	int32			fSelection;
 
 	bool			fShowingPopUpMenu;
+	int32			fDragIndex;			// -1 unless the mouse is down
+	BPoint			fDragStart;
+
+	// The level of an item is only worked out when it's drawn, and the
+	// runner only wakes us up when the next visible item is due.
+	FadeSchedule	fFade;
+	std::vector<rgb_color> fFadeColors;	// Per level
+	bigtime_t		fFadeTime;			// Stands still while paused
+	bool			fFadePaused;
+	bigtime_t		fNextFade;			// 0 if nothing is due
 	BMessageRunner*	fRunner;
 };
 
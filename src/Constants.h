@@ -18,8 +18,16 @@ static const char kSettingsFolder[] = "Clipdinger";
 static const char kSettingsFile[] = "Clipdinger_settings";
 static const char kHistoryFile[] = "Clipdinger_history";
 static const char kFavoritesFile[] = "Clipdinger_favorites";
+static const char kIndexFile[] = "Clipdinger_index";
+static const char kJournalFile[] = "Clipdinger_journal";
+static const char kBlobFolder[] = "Clipdinger_blobs";
+
+// Record types of the favorites and settings files (see core/RecordFile.h)
+static const uint32 kFavoriteRecord = 'FAVR';	// string clip, string title
+static const uint32 kSettingsRecord = 'STNG';	// flattened BMessage
 
 static const int32 kDefaultLimit = 100;
+static const int32 kDefaultSizeLimit = 0;	// MB of clips, 0 for no limit
 static const int32 kDefaultTrayIcon = 1;
 static const int32 kDefaultAutoStart = 1;
 static const int32 kDefaultAutoPaste = 1;
@@ -29,6 +37,9 @@ static const int32 kDefaultFadeStep = 5;
 static const int32 kDefaultFadeMaxLevel = 8;
 static const int32 kMaxTitleChars = 100;
 static const int32 kMinuteUnits = 10; // minutes per unit
+static const int32 kFuzzyResults = 500;
+static const bigtime_t kSaveDelay = 500000; // saves within are coalesced
+static const int32 kHistoryOverscan = 10; // rows kept around the visible ones
 
 #define ACTIVATE			'actv'
 #define MENU_ADD			'madd'
@@ -53,11 +64,17 @@ static const int32 kMinuteUnits = 10; // minutes per unit
 #define INSERT_HISTORY		'ihis'
 #define INSERT_FAVORITE		'ifav'
 #define ADJUSTCOLORS		'acol'
+#define FADE_ITEMS			'fdit'
 #define PAUSE				'paus'
 #define CLIPMONITOR			'cmon'
 #define SETTINGS			'sett'
 #define FILTER_CLEAR		'ficl'
 #define FILTER_INPUT		'fiin'
+#define FUZZY_FILTER		'fuzz'
+#define FILTER_FOUND		'fifn'
+#define ICON_RESOLVED		'icnr'
+#define HISTORY_LOADED		'hlod'
+#define HISTORY_SHOW		'hsho'
 
 #define	TRAYICON			'tric'
 #define	AUTOSTART			'aust'
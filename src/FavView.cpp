@@ -16,6 +16,7 @@
 #include "ContextPopUp.h"
 #include "FavItem.h"
 #include "FavView.h"
+#include "Tracing.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "ClipList"
@@ -127,6 +128,8 @@ FavView::MakeFocus(bool focused)
 void
 FavView::MessageReceived(BMessage* message)
 {
+	TRACE_MESSAGE("FavView::MessageReceived", message->what);
+
 	switch (message->what) {
 		case FAV_DRAGGED:
 		{
@@ -0,0 +1,201 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <Entry.h>
+#include <MimeType.h>
+#include <NodeInfo.h>
+#include <OS.h>
+
+#include "Constants.h"
+#include "IconCache.h"
+#include "Tracing.h"
+
+
+// How long an icon is used before checking whether its app changed
+static const bigtime_t kCheckInterval = 5000000;
+
+
+IconCache::IconCache(int32 maxIcons)
+	:
+	fMaxIcons(maxIcons > 0 ? maxIcons : 1),
+	fQuitting(false)
+{
+	fThread = std::thread(&IconCache::_Run, this);
+}
+
+
+IconCache::~IconCache()
+{
+	{
+		std::lock_guard<std::mutex> _(fLock);
+		fQuitting = true;
+	}
+	fCondition.notify_one();
+	fThread.join();
+}
+
+
+void
+IconCache::SetTarget(const BMessenger& target)
+{
+	std::lock_guard<std::mutex> _(fLock);
+	fTarget = target;
+}
+
+
+IconRef
+IconCache::GetIcon(const char* path, int32 size)
+{
+	Key key(path, size);
+	std::lock_guard<std::mutex> _(fLock);
+
+	EntryMap::iterator found = fEntries.find(key);
+	if (found != fEntries.end()) {
+		Entry& entry = found->second;
+		// The app may have changed, the fetcher checks. Until then the
+		// icon we have is good enough.
+		if (!entry.pending && system_time() - entry.checked >= kCheckInterval)
+			_Request(key, entry);
+
+		fLRU.splice(fLRU.begin(), fLRU, entry.lru);
+		return entry.icon;
+	}
+
+	Entry entry;
+	entry.modified = -1;
+	entry.node = -1;
+	entry.checked = 0;
+	fLRU.push_front(key);
+	entry.lru = fLRU.begin();
+	_Request(key, fEntries.insert(std::make_pair(key, entry)).first->second);
+
+	while (fEntries.size() > fMaxIcons) {
+		fEntries.erase(fLRU.back());
+		fLRU.pop_back();
+	}
+	return IconRef();
+}
+
+
+void
+IconCache::MakeEmpty()
+{
+	std::lock_guard<std::mutex> _(fLock);
+	fEntries.clear();
+	fLRU.clear();
+	fQueue.clear();
+}
+
+
+void
+IconCache::_Request(const Key& key, Entry& entry)
+{
+	entry.pending = true;
+	fQueue.push_back(key);
+	fCondition.notify_one();
+}
+
+
+void
+IconCache::_Run()
+{
+	TRACE_THREAD("icon fetcher");
+
+	std::unique_lock<std::mutex> lock(fLock);
+	while (true) {
+		fCondition.wait(lock, [this] { return fQuitting || !fQueue.empty(); });
+		if (fQuitting)
+			return;
+
+		Key key = fQueue.front();
+		fQueue.pop_front();
+		EntryMap::iterator found = fEntries.find(key);
+		if (found == fEntries.end())
+			continue;
+		bool fetched = found->second.checked != 0;
+		time_t oldModified = found->second.modified;
+		ino_t oldNode = found->second.node;
+
+		// Without the lock, this may take a while
+		lock.unlock();
+		time_t modified;
+		ino_t node;
+		_Stat(key.first.c_str(), modified, node);
+		bool changed = !fetched || modified != oldModified
+			|| node != oldNode;
+		IconRef icon;
+		if (changed)
+			icon = _FetchIcon(key.first.c_str(), key.second);
+		lock.lock();
+
+		// It may have been dropped in the meantime
+		found = fEntries.find(key);
+		if (found == fEntries.end())
+			continue;
+		Entry& entry = found->second;
+		entry.pending = false;
+		entry.checked = system_time();
+		if (!changed)
+			continue;
+
+		entry.icon = icon;
+		entry.modified = modified;
+		entry.node = node;
+
+		BMessage message(ICON_RESOLVED);
+		message.AddString("path", key.first.c_str());
+		message.AddInt32("size", key.second);
+
+		// Not under the lock: with its port full, the window would wait
+		// for us while we wait for it in GetIcon(). Nor do we wait for a
+		// window that is gone or busy, the destructor may be joining us;
+		// the icon is in place for its next redraw either way.
+		BMessenger target(fTarget);
+		lock.unlock();
+		target.SendMessage(&message, (BHandler*)NULL, 0);
+		lock.lock();
+	}
+}
+
+
+/*static*/ void
+IconCache::_Stat(const char* path, time_t& modified, ino_t& node)
+{
+	struct stat st;
+	BEntry entry(path);
+	if (entry.GetStat(&st) != B_OK) {
+		modified = -1;
+		node = -1;
+		return;
+	}
+	modified = st.st_mtime;
+	node = st.st_ino;
+}
+
+
+/*static*/ IconRef
+IconCache::_FetchIcon(const char* path, int32 size)
+{
+	TRACE_SPAN("IconCache::_FetchIcon");
+
+	BBitmap* icon = new BBitmap(BRect(0, 0, size - 1, size - 1), 0,
+		B_RGBA32);
+
+	status_t status = B_ERROR;
+	BEntry entry(path);
+	entry_ref ref;
+	if (entry.InitCheck() == B_OK && entry.GetRef(&ref) == B_OK)
+		status = BNodeInfo::GetTrackerIcon(&ref, icon, icon_size(size));
+
+	if (status != B_OK) {
+		BMimeType type("application/x-vnd.Be-elfexecutable");
+		status = type.GetIcon(icon, icon_size(size));
+	}
+	if (status != B_OK) {
+		delete icon;
+		return IconRef();
+	}
+	return IconRef(icon);
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * The icons of the apps clips come from. Most clips come from a handful
+ * of apps, so their items share one bitmap per app and icon size instead
+ * of each fetching its own.
+ *
+ * Icons are fetched in a background thread, so that a slow or unmounted
+ * volume doesn't hold up the window. Until an icon is there, GetIcon()
+ * returns NULL. Once it arrives, the target gets an ICON_RESOLVED message
+ * with the "path" and "size" of the icon.
+ */
+
+#ifndef ICONCACHE_H
+#define ICONCACHE_H
+
+#include <Bitmap.h>
+#include <Messenger.h>
+
+#include <sys/stat.h>
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+
+typedef std::shared_ptr<const BBitmap> IconRef;
+
+
+class IconCache {
+public:
+						IconCache(int32 maxIcons = 64);
+						~IconCache();
+
+	void				SetTarget(const BMessenger& target);
+
+	// The icon of the app at 'path', the generic app icon if it has none
+	// or doesn't exist (anymore). NULL while it's being fetched, or if
+	// there's no icon at all. Icons stay valid as long as someone holds a
+	// reference, even if the cache dropped them.
+	IconRef				GetIcon(const char* path, int32 size);
+	void				MakeEmpty();
+
+private:
+	typedef std::pair<std::string, int32> Key;
+
+	struct Entry {
+		IconRef				icon;
+		// Of the app when the icon was fetched, to notice it changed
+		time_t				modified;
+		ino_t				node;
+		bigtime_t			checked;
+		bool				pending;	// Queued for the fetcher
+		std::list<Key>::iterator lru;
+	};
+
+	typedef std::map<Key, Entry> EntryMap;
+
+	void				_Request(const Key& key, Entry& entry);
+	void				_Run();
+	static	void		_Stat(const char* path, time_t& modified, ino_t& node);
+	static	IconRef		_FetchIcon(const char* path, int32 size);
+
+	std::mutex			fLock;
+	std::condition_variable fCondition;
+	EntryMap			fEntries;
+	std::list<Key>		fLRU;			// Most recently used first
+	size_t				fMaxIcons;
+	std::deque<Key>		fQueue;
+	BMessenger			fTarget;
+	bool				fQuitting;
+	std::thread			fThread;
+};
+
+#endif // ICONCACHE_H
@@ -64,23 +64,25 @@ KeyCatcher::KeyDown(const char* bytes, int32 numBytes)
 			}
 			case B_BACKSPACE:
 			{
-				BMessenger messenger(Looper());
-				BMessage message(FILTER_INPUT);
-				message.AddString("input", "BACKSPACE");
-				messenger.SendMessage(&message);
+				_SendFilterInput("BACKSPACE");
 				break;
 			}
 			default:
 			{ // Send all ASCII and UTF characters to MainWindow
-				if ((bytes[0] >= '!' && bytes[0] <= '~') || ((unsigned char) bytes[0] >= 0xC0)) {
-					BString input(bytes);
-					BMessenger messenger(Looper());
-					BMessage message(FILTER_INPUT);
-					message.AddString("input", input.String());
-					messenger.SendMessage(&message);
-				}
+				if ((bytes[0] >= '!' && bytes[0] <= '~') || ((unsigned char) bytes[0] >= 0xC0))
+					_SendFilterInput(bytes);
 				break;
 			}
 		}
 	}
 }
+
+
+void
+KeyCatcher::_SendFilterInput(const char* input)
+{
+	BMessenger messenger(Looper());
+	BMessage message(FILTER_INPUT);
+	message.AddString("input", input);
+	messenger.SendMessage(&message);
+}
@@ -19,6 +19,9 @@ public:
 
 	virtual void	AttachedToWindow();
 	virtual	void	KeyDown(const char* bytes, int32 numBytes);
+
+private:
+	void			_SendFilterInput(const char* input);
 };
 
 #endif // KEYCATCHER_H_H
@@ -22,14 +22,21 @@
 #include <Screen.h>
 
 #include <algorithm>
+#include <utility>
+
+#include <string.h>
 
 #include "App.h"
-#include "ClipItem.h"
 #include "Constants.h"
 #include "FavItem.h"
+#include "FuzzyMatcher.h"
 #include "IconMenuItem.h"
+#include "Instrumentation.h"
 #include "KeyCatcher.h"
 #include "MainWindow.h"
+#include "MappedFile.h"
+#include "RecordFile.h"
+#include "Tracing.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "MainWindow"
@@ -41,8 +48,22 @@ MainWindow::MainWindow(BRect frame)
 	:
 	BWindow(frame, B_TRANSLATE_SYSTEM_NAME("Clipdinger"), B_TITLED_WINDOW,
 		B_NOT_ZOOMABLE | B_AUTO_UPDATE_SIZE_LIMITS, B_ALL_WORKSPACES),
+	fStore(kDefaultLimit),
+	fFilter(fStore),
+	fFilterGeneration(0),
+	fFilterShown(false),
+	fWriter(kSaveDelay),
+	fJournal(fWriter),
+	fLoader(fWriter),
+	fLoading(false),
+	fHistoryCleared(false),
+	fQuitTime(0),
+	fLoadStart(trace_now()),
+	fCapturing(false),
 	fDoQuit(false)
 {
+	TRACE_SPAN("MainWindow::MainWindow");
+
 	KeyCatcher* catcher = new KeyCatcher("catcher");
 	AddChild(catcher);
 	catcher->Hide();
@@ -61,35 +82,44 @@ MainWindow::MainWindow(BRect frame)
 	}
 	Settings* settings = my_app->GetSettings();
 	int32 fade = 0;
+	bool fuzzy = false;
 	if (settings->Lock()) {
 		fAutoPaste = settings->GetAutoPaste();
-		fLimit = settings->GetLimit();
+		fStore.SetLimit(settings->GetLimit());
+		fStore.SetByteLimit((uint64)settings->GetSizeLimit() << 20);
 		fade = settings->GetFade();
+		fuzzy = settings->GetFuzzyFilter();
 		settings->Unlock();
 	}
 
 	fMenuPauseFading->SetEnabled(fade);
+	fMenuFuzzyFilter->SetMarked(fuzzy);
 
 	fLaunchTime = real_time_clock();
 
+	// Icons are fetched in the background, the items get them later
+	fIcons.SetTarget(BMessenger(this));
+	// And the filter matches, see _FilterFound()
+	BMessenger messenger(this);
+	fFilter.SetFoundFunction([messenger](uint32 generation,
+			bigtime_t timeout) {
+		BMessage message(FILTER_FOUND);
+		message.AddUInt32("generation", generation);
+		return messenger.SendMessage(&message, (BHandler*)NULL, timeout)
+			== B_OK;
+	});
 	_LoadHistory();
 	_LoadFavorites();
 
 	if (fFavorites->CountItems() > 0)
 		_UpdateControls();
 
-	if (!fHistory->IsEmpty())
-		fHistory->Select(0);
 	if (!fFavorites->IsEmpty())
 		fFavorites->Select(0);
 
-	if (_GetClipboard() == "") {
-		if (!fHistory->IsEmpty()) {
-			ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(0));
-			BString text(item->GetClip());
-			_PutClipboard(text);
-		}
-	}
+	// Clips are captured while the history is still loading. The newest
+	// clip of the history goes into an empty clipboard once it's there,
+	// see _ShowHistory().
 	be_clipboard->StartWatching(this);
 	PostMessage(B_CLIPBOARD_CHANGED);
 }
@@ -109,14 +139,16 @@ MainWindow::QuitRequested()
 		return false;
 	}
 
-	BString filter = fFilterControl->Text();
-	if (filter != "")
-		_ResetFilter();
+	// The clips captured meanwhile have to get into the journal
+	if (fLoading)
+		_HistoryLoaded(fLoader.Wait());
 
-// we already save history and favorites with every new clip until
+// we already save favorites with every change until
 // https://review.haiku-os.org/c/haiku/+/5800 is solved
-//	_SaveHistory();
 //	_SaveFavorites();
+	_SaveIndex();
+	fJournal.Close(real_time_clock());
+	fWriter.Flush();
 
 	Settings* settings = my_app->GetSettings();
 	if (settings->Lock()) {
@@ -141,19 +173,32 @@ MainWindow::QuitRequested()
 void
 MainWindow::MessageReceived(BMessage* message)
 {
+	TRACE_MESSAGE("MainWindow::MessageReceived", message->what);
+
 	switch (message->what) {
 		case B_COLORS_UPDATED:
 		{
-			if (message->HasColor(ui_color_name(B_LIST_BACKGROUND_COLOR))) {
-				fHistory->MakeEmpty();
-				_LoadHistory();
-			}
+			// Recolored in place, the items get their colors when drawn
+			if (message->HasColor(ui_color_name(B_LIST_BACKGROUND_COLOR)))
+				fHistory->AdjustColors();
+			else
+				fHistory->Invalidate();
+			fFavorites->Invalidate();
 			break;
 		}
 		case B_CLIPBOARD_CHANGED:
 		{
-			BString clip(_GetClipboard());
-			if (clip.Length() == 0)
+			INSTRUMENT_SCOPE("clipboard_changed");
+
+			// Time to the first look at the clipboard, clip or not
+			if (!fCapturing) {
+				fCapturing = true;
+				TRACE_SINCE("MainWindow: first capture", fLoadStart);
+			}
+
+			// Copied once, the history shares it from now on
+			ClipBufferRef clip = _GetClipboard();
+			if (clip == NULL)
 				break;
 			fHistory->DeselectAll();
 
@@ -163,23 +208,33 @@ MainWindow::MessageReceived(BMessage* message)
 			BEntry entry(&info.ref);
 			entry.GetPath(&path);
 
-			BString filter = fFilterControl->TextView()->Text();
-			if (filter != "") {
-				_RestoreHistory();
-				fBackup.MakeEmpty();
-			}
-
-			_MakeItemUnique(clip);
+			_MakeItemUnique(*clip);
 			bigtime_t time(real_time_clock());
 			_AddClip(clip, NULL, path.Path(), time, time);
-
-			if (filter != "")
-				PostMessage(FILTER_INPUT);
+			_ClipsChanged();
 
 			fHistory->Select(0);
-// save history with every new clip until
-// https://review.haiku-os.org/c/haiku/+/5800 is solved
-_SaveHistory();
+			break;
+		}
+		case HISTORY_LOADED:
+		{
+			// Unless QuitRequested() was quicker
+			if (fLoading)
+				_HistoryLoaded(fLoader.Wait());
+			break;
+		}
+		case HISTORY_SHOW:
+		{
+			_ShowHistory();
+			break;
+		}
+		case ICON_RESOLVED:
+		{
+			const char* path;
+			int32 size;
+			if (message->FindString("path", &path) == B_OK
+				&& message->FindInt32("size", &size) == B_OK)
+				fHistory->UpdateIcons(path, size);
 			break;
 		}
 		case MINIMIZE:
@@ -217,6 +272,26 @@ _SaveHistory();
 				settings->SetFadePause(!pause);
 				settings->Unlock();
 			}
+			_UpdateColors();
+			break;
+		}
+		case FUZZY_FILTER:
+		{
+			bool fuzzy = !fMenuFuzzyFilter->IsMarked();
+			fMenuFuzzyFilter->SetMarked(fuzzy);
+
+			Settings* settings = my_app->GetSettings();
+			if (settings->Lock()) {
+				settings->SetFuzzyFilter(fuzzy);
+				settings->Unlock();
+			}
+
+			BString filter = fFilterControl->Text();
+			if (filter != "") {
+				// Filter again in the new mode
+				fFilter.Reset();
+				_Filter(filter);
+			}
 			break;
 		}
 		case DELETE:
@@ -225,26 +300,27 @@ _SaveHistory();
 				int32 index = fHistory->CurrentSelection();
 				if (index < 0)
 					break;
-				fHistory->RemoveItem(index);
-
-				int32 count = fHistory->CountItems();
-				// Only item left deleted: clear clipboard
-				if (count == 0) {
+				int32 removed = fStore.IndexOf(fHistory->RowAt(index));
+				fFilter.Cancel();
+				fStore.RemoveClip(removed);
+				_ClipsChanged();
+
+				// Only clip left deleted: clear clipboard. While filtering,
+				// the rows only come back with FILTER_FOUND.
+				if (fStore.IsEmpty()) {
 					_PutClipboard("");
-					_SaveHistory();
 					break;
 				}
 
-				fHistory->Select((index > count - 1) ? count - 1 : index);
+				int32 count = fHistory->CountRows();
+				if (count > 0)
+					fHistory->Select((index > count - 1) ? count - 1 : index);
 
-				if (index == 0) {
-					ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(0));
-					BString text(item->GetClip());
-					_PutClipboard(text);
+				if (removed == 0) {
+					ClipRecord* record = fStore.ClipAt(0);
+					_PutClipboard(record->GetClipData(),
+						record->GetClipLength());
 				}
-// save history with every new clip until
-// https://review.haiku-os.org/c/haiku/+/5800 is solved
-_SaveHistory();
 			} else if (!GetHistoryActiveFlag() && !fFavorites->IsEmpty()) {
 				int32 index = fFavorites->CurrentSelection();
 				if (index < 0)
@@ -268,8 +344,7 @@ _SaveFavorites();
 				if (index < 0)
 					break;
 
-				ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(index));
-				text = item->GetTitle();
+				text = _GetTitle(fHistory->RowAt(index));
 
 			} else if (!GetHistoryActiveFlag() && !fFavorites->IsEmpty()) {
 				int32 index = fFavorites->CurrentSelection();
@@ -295,13 +370,10 @@ _SaveFavorites();
 					break;
 
 				if (message->FindString("edit_title", &newTitle) == B_OK) {
-					ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(index));
-					item->SetTitle(newTitle, true);
-					fHistory->InvalidateItem(index);
+					fStore.SetTitle(fHistory->RowAt(index),
+						std::string(newTitle.String(), newTitle.Length()));
+					fHistory->RowChanged(index);
 				}
-// save history with every new clip until
-// https://review.haiku-os.org/c/haiku/+/5800 is solved
-_SaveHistory();
 			} else if (!GetHistoryActiveFlag() && !fFavorites->IsEmpty()) {
 				int32 index = fFavorites->CurrentSelection();
 				if (index < 0)
@@ -334,13 +406,12 @@ _SaveFavorites();
 
 			int32 index = fFavorites->CountItems();
 			if (command == FAV_ADD) {
-				ClipItem* clip
-					= dynamic_cast<ClipItem*>(fHistory->ItemAt(fHistory->CurrentSelection()));
-				if (clip == NULL)
+				ClipRecord* record = fHistory->RowAt(fHistory->CurrentSelection());
+				if (record == NULL)
 					break;
 
-				BString title(clip->GetTitle());
-				BString contents(clip->GetClip());
+				BString title(_GetTitle(record));
+				BString contents(_GetClip(record));
 				if (title == contents)
 					title = "";
 
@@ -456,12 +527,14 @@ _SaveFavorites();
 			if (filter == "")
 				be_clipboard->StopWatching(this);
 
-			ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(itemindex));
-			BString text(item->GetClip());
+			// The record outlives the rows of the filtered list
+			ClipRecord* record = fHistory->RowAt(itemindex);
+			if (record == NULL)
+				break;
 			if (filter != "")
 				_ResetFilter();
 
-			_PutClipboard(text);
+			_PutClipboard(record->GetClipData(), record->GetClipLength());
 
 			if (fAutoPaste)
 				_AutoPaste();
@@ -510,11 +583,8 @@ _SaveFavorites();
 			if (filter != "")
 				_ResetFilter();
 
-			fHistory->MakeEmpty();
+			_EmptyHistory();
 			PostMessage(B_CLIPBOARD_CHANGED);
-// save history with every new clip until
-// https://review.haiku-os.org/c/haiku/+/5800 is solved
-_SaveHistory();
 			break;
 		}
 		case HELP:
@@ -526,12 +596,14 @@ _SaveHistory();
 		{
 			int32 newValue;
 			if (message->FindInt32("limit", &newValue) == B_OK) {
-				if (fLimit >= newValue)
+				if (fStore.Limit() >= newValue)
 					_CropHistory(newValue);
 
-				if (fLimit != newValue)
-					fLimit = newValue;
+				if (fStore.Limit() != newValue)
+					fStore.SetLimit(newValue);
 			}
+			if (message->FindInt32("sizelimit", &newValue) == B_OK)
+				_SetSizeLimit(newValue);
 
 			if (message->FindInt32("autopaste", &newValue) == B_OK)
 				fAutoPaste = newValue;
@@ -559,8 +631,7 @@ _SaveHistory();
 		}
 		case FILTER_INPUT:
 		{
-			if (fBackup.IsEmpty())
-				_BackupHistory();
+			INSTRUMENT_SCOPE("filter_input");
 
 			BString filter = fFilterControl->TextView()->Text();
 
@@ -589,15 +660,14 @@ _SaveHistory();
 				_ResetFilter();
 				break;
 			}
-			_RestoreHistory();
-
-			for (int32 i = fHistory->CountItems() - 1; i >= 0; i--) {
-				ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(i));
-				BString clip(item->GetClip());
-				if (strcasestr(clip.String(), filter.String()) == NULL)
-					fHistory->RemoveItem(i);
-			}
-			fHistory->Select(0);
+			_Filter(filter);
+			break;
+		}
+		case FILTER_FOUND:
+		{
+			uint32 generation;
+			if (message->FindUInt32("generation", &generation) == B_OK)
+				_FilterFound(generation);
 			break;
 		}
 		default:
@@ -612,8 +682,9 @@ _SaveHistory();
 void
 MainWindow::WindowActivated(bool active)
 {
+	// Only the items that are due get faded
 	if (active)
-		_UpdateColors();
+		fHistory->UpdateFading();
 }
 
 // #pragma mark - Layout
@@ -623,39 +694,112 @@ void
 MainWindow::_ResetFilter()
 {
 	fFilterControl->SetText("");
+	fFilter.Reset();
 
-	_RestoreHistory();
-
+	fHistory->ShowAll();
 	fHistory->Select(0);
-	fBackup.MakeEmpty();
 }
 
 
 void
-MainWindow::_BackupHistory()
+MainWindow::_Filter(const BString& filter)
+{
+	// The matches come in with FILTER_FOUND, until then the previous ones
+	// are shown
+	if (fMenuFuzzyFilter->IsMarked())
+		_FuzzyFilter(filter);
+	else
+		fFilterGeneration = fFilter.Start(filter.String());
+	fFilterShown = false;
+}
+
+
+void
+MainWindow::_FuzzyFilter(const BString& filter)
 {
-	fBackup.MakeEmpty();
-	for (int32 i = fHistory->CountItems() - 1; i >= 0; i--) {
-		ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(i));
-		fBackup.AddItem(item);
+	// Ranked over the whole history, best match first
+	fFilterGeneration = fFilter.StartFuzzy(filter.String(),
+		real_time_clock(), kFuzzyResults);
+
+	// Favorites aren't filtered, that would mess up their F-key numbers.
+	// Just select the best matching one.
+	FuzzyMatcher matcher(filter.String());
+	int32 bestIndex = -1;
+	int32 bestScore = 0;
+	for (int32 i = 0; i < fFavorites->CountItems(); i++) {
+		FavItem* item = dynamic_cast<FavItem*>(fFavorites->ItemAt(i));
+		BString clip = item->GetClip();
+		int32 score;
+		if (matcher.Score(clip.String(), clip.Length(), &score)
+			&& (bestIndex < 0 || score > bestScore)) {
+			bestIndex = i;
+			bestScore = score;
+		}
+	}
+	if (bestIndex >= 0) {
+		fFavorites->Select(bestIndex);
+		fFavorites->ScrollToSelection();
 	}
 }
 
 
 void
-MainWindow::_RestoreHistory()
+MainWindow::_FilterFound(uint32 generation)
 {
-	fHistory->MakeEmpty();
-	for (int32 i = fBackup.CountItems() - 1; i >= 0; i--) {
-		ClipItem* item = dynamic_cast<ClipItem*>(fBackup.ItemAt(i));
-		fHistory->AddItem(item);
+	std::vector<int32> matches;
+	bool done;
+	if (generation != fFilterGeneration
+		|| !fFilter.GetMatches(generation, matches, done))
+		return;
+
+	// More matches of the same query keep the selected clip
+	ClipRecord* selected = NULL;
+	if (fFilterShown)
+		selected = fHistory->RowAt(fHistory->CurrentSelection());
+
+	fHistory->ShowOnly(matches);
+	fFilterShown = true;
+
+	int32 selection = 0;
+	for (int32 i = 0; selected != NULL && i < fHistory->CountRows(); i++) {
+		if (fHistory->RowAt(i) == selected) {
+			selection = i;
+			break;
+		}
 	}
+	fHistory->Select(selection);
+}
+
+
+void
+MainWindow::_ClipsChanged()
+{
+	// While filtering, the store indexes of the matches are stale
+	BString filter = fFilterControl->Text();
+	if (filter != "") {
+		fHistory->ShowOnly(std::vector<int32>());
+		_Filter(filter);
+	} else
+		fHistory->ClipsChanged();
+}
+
+
+void
+MainWindow::_EmptyHistory()
+{
+	fFilter.Cancel();
+	fStore.MakeEmpty();
+	_ClipsChanged();
+	if (fLoading)
+		fHistoryCleared = true;
 }
 
 
 void
 MainWindow::_BuildLayout()
 {
+	TRACE_SPAN("MainWindow::_BuildLayout");
+
 	// The menu
 	BMenuBar* menuBar = new BMenuBar("menubar");
 	BMenuItem* item;
@@ -702,10 +846,12 @@ MainWindow::_BuildLayout()
 	menu->AddSeparatorItem();
 	fMenuPauseFading = new BMenuItem(B_TRANSLATE("Pause fading"), new BMessage(PAUSE), 'F');
 	menu->AddItem(fMenuPauseFading);
+	fMenuFuzzyFilter = new BMenuItem(B_TRANSLATE("Fuzzy filter"), new BMessage(FUZZY_FILTER));
+	menu->AddItem(fMenuFuzzyFilter);
 	menuBar->AddItem(menu);
 
 	// The lists
-	fHistory = new ClipView("historyview");
+	fHistory = new ClipView("historyview", fStore, fIcons);
 	fHistory->SetExplicitMaxSize(BSize(B_SIZE_UNLIMITED, B_SIZE_UNSET));
 
 	fFavorites = new FavView("favoritesview");
@@ -753,7 +899,7 @@ MainWindow::_BuildLayout()
 		.SetInsets(B_USE_SMALL_INSETS)
 		.End();
 
-	fHistory->SetInvocationMessage(new BMessage(INSERT_HISTORY));
+	fHistory->SetMessage(new BMessage(INSERT_HISTORY));
 	fHistory->SetViewColor(B_TRANSPARENT_COLOR);
 	fFavorites->SetInvocationMessage(new BMessage(INSERT_FAVORITE));
 	fFavorites->SetSelectionMessage(new BMessage(FAV_SELECTION));
@@ -788,10 +934,11 @@ MainWindow::_SetSplitview()
 
 
 void
-MainWindow::_SaveHistory()
+MainWindow::_LoadHistory()
 {
+	TRACE_SPAN("MainWindow::_LoadHistory");
+
 	BPath path;
-	BMessage msg;
 	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK)
 		return;
 	status_t ret = path.Append(kSettingsFolder);
@@ -799,86 +946,230 @@ MainWindow::_SaveHistory()
 	if (ret == B_OK)
 		ret = create_directory(path.Path(), 0777);
 
+	BPath journalPath(path);
+	if (ret == B_OK)
+		ret = journalPath.Append(kJournalFile);
+
+	BPath indexPath(path);
 	if (ret == B_OK)
+		ret = indexPath.Append(kIndexFile);
+
+	if (ret != B_OK)
+		return;
+
+	// Large clips go to files of their own
+	BPath blobPath(path);
+	if (blobPath.Append(kBlobFolder) == B_OK
+		&& fBlobs.SetTo(blobPath.Path()) == B_OK) {
+		fBlobs.SetWriter(&fWriter);
+		fStore.SetBlobStore(&fBlobs);
+	}
+
+	_EmptyHistory();
+	fJournalPath = journalPath.Path();
+
+	BEntry entry(journalPath.Path());
+	if (!entry.Exists()) {
+		INSTRUMENT_SCOPE("load_history");
+
+		// No journal yet, start it from the old history file
+		fStore.SuspendIndex();
 		path.Append(kHistoryFile);
+		fQuitTime = _ImportHistory(path.Path());
+		fJournal.Create(journalPath.Path(), fStore);
+		fStore.PruneBlobs();
+		_LoadIndex();
+		if (fQuitTime == 0)
+			fQuitTime = real_time_clock();
+		for (int32 i = 0; i < fStore.CountClips(); i++) {
+			ClipRecord* record = fStore.ClipAt(i);
+			record->SetTimeSince(record->GetTimeAdded()
+				+ (fLaunchTime - fQuitTime));
+		}
+		PostMessage(HISTORY_SHOW);
+		return;
+	}
 
-	if (ret == B_OK) {
-		BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
-		ret = file.InitCheck();
+	// A large history takes a while. Until it's there, new clips are
+	// captured into the empty fStore and it's merged below them.
+	fLoading = true;
+	fHistoryCleared = false;
+	BMessenger messenger(this);
+	fLoader.Start(journalPath.Path(), indexPath.Path(), fStore,
+		[this, messenger](status_t) {
+			// QuitRequested() may be waiting for us with a full port, it
+			// takes the result itself then
+			BMessage message(HISTORY_LOADED);
+			status_t status;
+			do {
+				status = messenger.SendMessage(&message, (BHandler*)NULL,
+					100000);
+			} while (status == B_TIMED_OUT && !fLoader.IsWaitedFor());
+		});
+}
 
-		if (ret == B_OK) {
-			for (int i = fHistory->CountItems() - 1; i >= 0; i--) {
-				ClipItem* sItem = dynamic_cast<ClipItem*>(fHistory->ItemAt(i));
 
-				BString clip(sItem->GetClip());
-				BString title(sItem->GetTitle());
-				if (title == clip)
-					title = "";
-				BString path(sItem->GetOrigin());
-				bigtime_t added(sItem->GetTimeAdded());
-				msg.AddString("clip", clip.String());
-				msg.AddString("title", title.String());
-				msg.AddString("origin", path.String());
-				msg.AddInt64("time", added);
-			}
-			msg.AddInt64("quittime", real_time_clock());
-			msg.Flatten(&file);
+void
+MainWindow::_HistoryLoaded(status_t status)
+{
+	fLoading = false;
+
+	fFilter.Cancel();
+	ClipStore& loaded = fLoader.Store();
+	if (status == B_OK && !fHistoryCleared) {
+		fQuitTime = fLoader.QuitTime();
+		if (fQuitTime == 0)
+			fQuitTime = real_time_clock();
+		for (int32 i = 0; i < loaded.CountClips(); i++) {
+			ClipRecord* record = loaded.ClipAt(i);
+			record->SetTimeSince(record->GetTimeAdded()
+				+ (fLaunchTime - fQuitTime));
 		}
+
+		// The clips captured so far are newer than the whole journal
+		fJournal.Attach(fJournalPath.String(), fStore,
+			fLoader.CountRecords());
+		fStore.MergeOlder(loaded);
+		fStore.PruneBlobs();
+	} else if (status == B_OK || status == B_ENTRY_NOT_FOUND) {
+		// Cleared while loading, or there's no journal anymore
+		fLoader.Discard();
+		fJournal.Create(fJournalPath.String(), fStore);
+		fStore.PruneBlobs();
+	} else {
+		// Never overwrite a journal that couldn't be read, nor prune the
+		// blobs it refers to
+		fLoader.Discard();
+		_SetJournalAside(status);
 	}
+	_ClipsChanged();
+
+	PostMessage(HISTORY_SHOW);
 }
 
 
 void
-MainWindow::_LoadHistory()
+MainWindow::_SetJournalAside(status_t error)
 {
-	BPath path;
-	BMessage msg;
+	BString brokenPath(fJournalPath);
+	brokenPath << ".broken-" << real_time_clock();
 
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) == B_OK) {
-		status_t ret = path.Append(kSettingsFolder);
-		if (ret == B_OK) {
-			path.Append(kHistoryFile);
-			BFile file(path.Path(), B_READ_ONLY);
-
-			if (file.InitCheck() != B_OK || (msg.Unflatten(&file) != B_OK))
-				return;
-			else {
-				fHistory->MakeEmpty();
-
-				BString clip;
-				BString title;
-				BString path;
-				int32 old_added = 0; // used int32 pre v.0.5.5,
-				int32 old_quittime = 0; // read old history files too.
-				bigtime_t added = 0;
-				bigtime_t quittime = 0;
-				bigtime_t since = 0;
-
-				if (msg.FindInt32("quittime", &old_quittime) == B_OK)
-					quittime = (int64) old_quittime;
-				else if (msg.FindInt64("quittime", &quittime) != B_OK)
-					quittime = real_time_clock();
-
-				int32 i = 0;
-				while ((msg.FindString("clip", i, &clip) == B_OK)
-					&& (msg.FindString("origin", i, &path) == B_OK)
-					&& ((msg.FindInt32("time", i, &old_added) == B_OK)
-						|| (msg.FindInt64("time", i, &added) == B_OK))) {
-
-					if (msg.FindString("title", i, &title) != B_OK)
-						title = ""; // if there's no title found (pre v1.0)
-
-					if (added == 0)
-						added = (int64) old_added;
-
-					since = added + (fLaunchTime - quittime);
-					_AddClip(clip, title, path, added, since);
-					i++;
-				}
-				fHistory->AdjustColors();
-			}
-		}
+	BEntry entry(fJournalPath.String());
+	status_t ret = entry.Rename(brokenPath.String());
+	if (ret == B_OK)
+		fJournal.Create(fJournalPath.String(), fStore);
+
+	// Without a journal, the clips of this session aren't saved
+	BString text(B_TRANSLATE("The clip history couldn't be loaded: %error%."));
+	text.ReplaceFirst("%error%", strerror(error));
+	text << "\n\n";
+	if (ret == B_OK) {
+		text << B_TRANSLATE("It was kept as '%path%'.");
+		text.ReplaceFirst("%path%", brokenPath.String());
+	} else {
+		text << B_TRANSLATE("It was left untouched, and new clips won't be "
+			"saved.");
+	}
+
+	BAlert* alert = new BAlert("error", text, B_TRANSLATE("OK"),
+		NULL, NULL, B_WIDTH_AS_USUAL, B_STOP_ALERT);
+	alert->Go(NULL);
+}
+
+
+void
+MainWindow::_ShowHistory()
+{
+	// The ClipView only creates items for the rows in view, so the whole
+	// history is there at once
+	_ClipsChanged();
+	if (!fHistory->IsEmpty() && fHistory->CurrentSelection() < 0)
+		fHistory->Select(0);
+
+	if (_GetClipboard() == NULL && !fStore.IsEmpty()) {
+		ClipRecord* record = fStore.ClipAt(0);
+		_PutClipboard(record->GetClipData(), record->GetClipLength());
+	}
+
+	TRACE_SINCE("MainWindow: history shown", fLoadStart);
+}
+
+
+bigtime_t
+MainWindow::_ImportHistory(const char* path)
+{
+	BMessage msg;
+	BFile file(path, B_READ_ONLY);
+	if (file.InitCheck() != B_OK || (msg.Unflatten(&file) != B_OK))
+		return 0;
+
+	BString clip;
+	BString title;
+	BString origin;
+	int32 old_added = 0; // used int32 pre v.0.5.5,
+	int32 old_quittime = 0; // read old history files too.
+	bigtime_t added = 0;
+	bigtime_t quittime = 0;
+
+	if (msg.FindInt32("quittime", &old_quittime) == B_OK)
+		quittime = (int64) old_quittime;
+	else if (msg.FindInt64("quittime", &quittime) != B_OK)
+		quittime = real_time_clock();
+
+	int32 i = 0;
+	while ((msg.FindString("clip", i, &clip) == B_OK)
+		&& (msg.FindString("origin", i, &origin) == B_OK)
+		&& ((msg.FindInt32("time", i, &old_added) == B_OK)
+			|| (msg.FindInt64("time", i, &added) == B_OK))) {
+
+		if (msg.FindString("title", i, &title) != B_OK)
+			title = ""; // if there's no title found (pre v1.0)
+
+		if (added == 0)
+			added = (int64) old_added;
+
+		ClipBufferRef contents = ClipBuffer::Create(clip.String(), clip.Length());
+		fStore.MakeUnique(*contents);
+		fStore.AddClip(contents, std::string(title.String(), title.Length()),
+			origin.String(), added, added);
+		i++;
 	}
+	return quittime;
+}
+
+
+void
+MainWindow::_SaveIndex()
+{
+	BPath path;
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK)
+		return;
+	status_t ret = path.Append(kSettingsFolder);
+
+	if (ret == B_OK)
+		ret = create_directory(path.Path(), 0777);
+
+	if (ret == B_OK)
+		ret = path.Append(kIndexFile);
+
+	// Written along with the journal when the writer is flushed
+	std::string buffer;
+	if (ret == B_OK && fStore.SnapshotIndex(buffer) == B_OK)
+		fWriter.Replace(path.Path(), std::move(buffer));
+}
+
+
+void
+MainWindow::_LoadIndex()
+{
+	BPath path;
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) == B_OK
+		&& path.Append(kSettingsFolder) == B_OK
+		&& path.Append(kIndexFile) == B_OK) {
+		// If the saved index doesn't fit the history, it gets rebuilt
+		fStore.LoadIndex(path.Path());
+	} else
+		fStore.LoadIndex("");
 }
 
 
@@ -886,7 +1177,6 @@ void
 MainWindow::_SaveFavorites()
 {
 	BPath path;
-	BMessage msg;
 
 	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) < B_OK)
 		return;
@@ -899,22 +1189,24 @@ MainWindow::_SaveFavorites()
 		path.Append(kFavoritesFile);
 
 	if (ret == B_OK) {
-		BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
-		ret = file.InitCheck();
-
-		if (ret == B_OK) {
-			for (int i = 0; i < fFavorites->CountItems(); i++) {
-				FavItem* sItem = dynamic_cast<FavItem*>(fFavorites->ItemAt(i));
-
-				BString clip(sItem->GetClip());
-				BString title(sItem->GetTitle());
-				if (title == clip)
-					title = "";
-				msg.AddString("clip", clip.String());
-				msg.AddString("title", title.String());
-			}
-			msg.Flatten(&file);
+		// A record per favorite, so a damaged one doesn't take the others
+		// with it. The writer thread saves a snapshot, quick changes get
+		// coalesced.
+		std::string data;
+		RecordWriter writer(data);
+		for (int i = 0; i < fFavorites->CountItems(); i++) {
+			FavItem* sItem = dynamic_cast<FavItem*>(fFavorites->ItemAt(i));
+
+			BString clip(sItem->GetClip());
+			BString title(sItem->GetTitle());
+			if (title == clip)
+				title = "";
+			writer.StartRecord(kFavoriteRecord);
+			writer.PutString(clip.String(), clip.Length());
+			writer.PutString(title.String(), title.Length());
+			writer.EndRecord();
 		}
+		fWriter.Replace(path.Path(), std::move(data));
 	}
 }
 
@@ -922,28 +1214,55 @@ MainWindow::_SaveFavorites()
 void
 MainWindow::_LoadFavorites()
 {
+	TRACE_SPAN("MainWindow::_LoadFavorites");
+
 	BPath path;
+
+	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) != B_OK
+		|| path.Append(kSettingsFolder) != B_OK
+		|| path.Append(kFavoritesFile) != B_OK)
+		return;
+
+	MappedFile file(path.Path());
+	if (file.InitCheck() != B_OK)
+		return;
+
+	// Every intact favorite is salvaged
+	RecordScanner scanner(file.Data(), file.Size());
+	uint32 type;
+	const char* data;
+	uint32 size;
+	bool found = false;
+	int32 i = 0;
+	while (scanner.Next(type, data, size)) {
+		found = true;
+		RecordReader reader(data, size);
+		const char* clip;
+		const char* title;
+		uint32 clipLength;
+		uint32 titleLength;
+		if (type != kFavoriteRecord || !reader.GetString(clip, clipLength)
+			|| !reader.GetString(title, titleLength))
+			continue;
+
+		fFavorites->AddItem(new FavItem(BString(clip, clipLength),
+			BString(title, titleLength), i), i);
+		i++;
+	}
+	if (found)
+		return;
+
+	// Favorites saved by older versions
 	BMessage msg;
+	if (msg.Unflatten(file.Data()) != B_OK)
+		return;
 
-	if (find_directory(B_USER_SETTINGS_DIRECTORY, &path) == B_OK) {
-		status_t ret = path.Append(kSettingsFolder);
-		if (ret == B_OK) {
-			path.Append(kFavoritesFile);
-			BFile file(path.Path(), B_READ_ONLY);
-
-			if (file.InitCheck() != B_OK || (msg.Unflatten(&file) != B_OK))
-				return;
-			else {
-				BString clip;
-				BString title;
-				int32 i = 0;
-				while (msg.FindString("clip", i, &clip) == B_OK
-					&& msg.FindString("title", i, &title) == B_OK) {
-					fFavorites->AddItem(new FavItem(clip, title, i), i);
-					i++;
-				}
-			}
-		}
+	BString clip;
+	BString title;
+	while (msg.FindString("clip", i, &clip) == B_OK
+		&& msg.FindString("title", i, &title) == B_OK) {
+		fFavorites->AddItem(new FavItem(clip, title, i), i);
+		i++;
 	}
 }
 
@@ -973,58 +1292,81 @@ MainWindow::_OpenHelp()
 
 // #pragma mark - Clips etc.
 
-void
-MainWindow::_AddClip(BString clip, BString title, BString path, bigtime_t added, bigtime_t since)
+BString
+MainWindow::_GetClip(const ClipRecord* record)
 {
-	if (fHistory->CountItems() > fLimit - 1)
-		fHistory->RemoveItem(fHistory->LastItem());
+	INSTRUMENT_COPY(record->GetClipLength());
+	return BString(record->GetClipData(), record->GetClipLength());
+}
+
 
-	fHistory->AddItem(new ClipItem(clip, title, path, added, since), 0);
+BString
+MainWindow::_GetTitle(const ClipRecord* record)
+{
+	if (!record->HasTitle())
+		return _GetClip(record);
+
+	const std::string& title = record->GetTitle();
+	return BString(title.c_str(), title.length());
 }
 
 
 void
-MainWindow::_MakeItemUnique(BString clip)
+MainWindow::_AddClip(const ClipBufferRef& clip, BString title, BString path,
+	bigtime_t added, bigtime_t since)
 {
-	if (fHistory->IsEmpty())
-		return;
+	fFilter.Cancel();
+	fStore.AddClip(clip, title.String(), path.String(), added, since);
+}
 
-	for (int i = 0; i < fHistory->CountItems(); i++) {
-		ClipItem* sItem = dynamic_cast<ClipItem*>(fHistory->ItemAt(i));
-		BString* listItem = new BString(sItem->GetClip());
 
-		if (clip.Compare(*listItem) == 0)
-			fHistory->RemoveItem(i);
-	}
+void
+MainWindow::_MakeItemUnique(const ClipBuffer& clip)
+{
+	fFilter.Cancel();
+	fStore.MakeUnique(clip);
 }
 
 
 void
 MainWindow::_MoveClipToTop()
 {
-	fHistory->MoveItem(fHistory->CurrentSelection(), 0);
-	fHistory->Select(0);
+	int32 index = fHistory->CurrentSelection();
+	ClipRecord* record = fHistory->RowAt(index);
+	if (record == NULL)
+		return;
 
-	bigtime_t time(real_time_clock());
-	ClipItem* item = dynamic_cast<ClipItem*>(fHistory->ItemAt(0));
-	item->SetTimeAdded(time);
+	fFilter.Cancel();
+	fStore.MoveToTop(fStore.IndexOf(record), real_time_clock());
+	_ClipsChanged();
+	fHistory->Select(0);
 }
 
 
 void
 MainWindow::_CropHistory(int32 limit)
 {
-	if (limit < fLimit) {
-		if (fHistory->CountItems() > limit) {
-			int count = fHistory->CountItems() - limit;
-			if (limit == 0)
-				limit = 1;
-			fHistory->RemoveItems(limit, count);
-		}
+	if (limit < fStore.Limit()) {
+		fFilter.Cancel();
+		fStore.Crop(limit);
+		_ClipsChanged();
 	}
 }
 
 
+void
+MainWindow::_SetSizeLimit(int32 megabytes)
+{
+	uint64 limit = (uint64)megabytes << 20;
+	if (limit == fStore.ByteLimit())
+		return;
+
+	fFilter.Cancel();
+	fStore.SetByteLimit(limit);
+	_ClipsChanged();
+}
+
+
 bool
 MainWindow::_CheckNetworkConnection()
 {
@@ -1053,8 +1395,7 @@ MainWindow::_UploadClip(void* self)
 		if (index < 0)
 			return B_ERROR;
 
-		ClipItem* item = dynamic_cast<ClipItem*>(window->fHistory->ItemAt(index));
-		text = item->GetClip();
+		text = window->_GetClip(window->fHistory->RowAt(index));
 
 	} else if (!window->GetHistoryActiveFlag() && !window->fFavorites->IsEmpty()) {
 		int32 index = window->fFavorites->CurrentSelection();
@@ -1118,19 +1459,23 @@ MainWindow::_UploadClip(void* self)
 // #pragma mark - Clipboard
 
 
-BString
+ClipBufferRef
 MainWindow::_GetClipboard()
 {
 	const char* text = NULL;
 	ssize_t textLen = 0;
 	BMessage* clipboard = (BMessage*)NULL;
+	ClipBufferRef clip;
 
+	// The data belongs to the clipboard, copy it while it's locked
 	if (be_clipboard->Lock()) {
-		if ((clipboard = be_clipboard->Data()))
-			clipboard->FindData("text/plain", B_MIME_TYPE, (const void**)&text, &textLen);
+		if ((clipboard = be_clipboard->Data())
+			&& clipboard->FindData("text/plain", B_MIME_TYPE,
+				(const void**)&text, &textLen) == B_OK
+			&& textLen > 0)
+			clip = ClipBuffer::Create(text, textLen);
 		be_clipboard->Unlock();
 	}
-	BString clip(text, textLen);
 	return clip;
 }
 
@@ -1138,13 +1483,19 @@ MainWindow::_GetClipboard()
 void
 MainWindow::_PutClipboard(BString text)
 {
-	ssize_t textLen = text.Length();
+	_PutClipboard(text.String(), text.Length());
+}
+
+
+void
+MainWindow::_PutClipboard(const char* text, ssize_t textLen)
+{
 	BMessage* clip = (BMessage*)NULL;
 
 	if (be_clipboard->Lock()) {
 		be_clipboard->Clear();
 		if ((clip = be_clipboard->Data())) {
-			clip->AddData("text/plain", B_MIME_TYPE, text.String(), textLen);
+			clip->AddData("text/plain", B_MIME_TYPE, text, textLen);
 			be_clipboard->Commit();
 		}
 		be_clipboard->Unlock();
@@ -32,10 +32,18 @@
 #include <stdlib.h>
 #include <strings.h>
 
-#include "ClipItem.h"
+#include <vector>
+
+#include "BlobStore.h"
+#include "ClipStore.h"
 #include "ClipView.h"
 #include "EditWindow.h"
 #include "FavView.h"
+#include "FileWriter.h"
+#include "FilterWorker.h"
+#include "HistoryJournal.h"
+#include "HistoryLoader.h"
+#include "IconCache.h"
 
 const int32	kControlKeys = B_COMMAND_KEY | B_SHIFT_KEY;
 
@@ -53,7 +61,6 @@ public:
 	void			SetHistoryActiveFlag(bool flag);
 	BString			GetFilterText() { return fFilterControl->Text(); }
 
-	BObjectList<ClipItem>		fBackup;
 	ClipView*		fHistory;
 	FavView*		fFavorites;
 
@@ -61,33 +68,65 @@ private:
 	void			_BuildLayout();
 	void			_SetSplitview();
 	void			_ResetFilter();
-	void			_BackupHistory();
-	void			_RestoreHistory();
+	void			_FuzzyFilter(const BString& filter);
+	void			_Filter(const BString& filter);
+	void			_FilterFound(uint32 generation);
+	// After every change of fStore, fHistory shows it
+	void			_ClipsChanged();
+	void			_EmptyHistory();
 
 	void			_LoadHistory();
-	void			_SaveHistory();
+	void			_HistoryLoaded(status_t status);
+	void			_SetJournalAside(status_t error);
+	void			_ShowHistory();
+	bigtime_t		_ImportHistory(const char* path);
+	void			_LoadIndex();
+	void			_SaveIndex();
 	void			_LoadFavorites();
 	void			_SaveFavorites();
 	void			_OpenHelp();
 
-	void			_AddClip(BString clip, BString title, BString path,
-						bigtime_t time, bigtime_t since);
-	void			_MakeItemUnique(BString clip);
+	BString			_GetClip(const ClipRecord* record);
+	// The clip if there's no title
+	BString			_GetTitle(const ClipRecord* record);
+	void			_AddClip(const ClipBufferRef& clip, BString title,
+						BString path, bigtime_t time, bigtime_t since);
+	void			_MakeItemUnique(const ClipBuffer& clip);
 	void			_MoveClipToTop();
 	void			_CropHistory(int32 limit);
+	void			_SetSizeLimit(int32 megabytes);
 	bool			_CheckNetworkConnection();
 	static status_t	_UploadClip(void* self);
 
-	BString			_GetClipboard();
+	// NULL if there's no text in the clipboard
+	ClipBufferRef	_GetClipboard();
 	void			_PutClipboard(BString text);
+	void			_PutClipboard(const char* text, ssize_t length);
 
 	void			_AutoPaste();
 	void			_UpdateControls();
 	void			_UpdateColors();
 
-	int32			fLimit;
+	BlobStore		fBlobs;			// Before fStore, which uses it
+	ClipStore		fStore;
+	// Runs the queries, and has to be cancelled before fStore changes
+	FilterWorker	fFilter;
+	uint32			fFilterGeneration;	// of the current query
+	bool			fFilterShown;		// some of its matches
+	FileWriter		fWriter;
+	HistoryJournal	fJournal;
+	HistoryLoader	fLoader;
+	IconCache		fIcons;
 	int32			fAutoPaste;
 	bigtime_t		fLaunchTime;
+
+	// The history is loaded in the background, see _LoadHistory()
+	BString			fJournalPath;
+	bool			fLoading;
+	bool			fHistoryCleared;	// while loading
+	bigtime_t		fQuitTime;			// of the loaded history
+	int64			fLoadStart;			// see trace_now()
+	bool			fCapturing;
 	thread_id		fThread;
 
 	BSplitView*		fMainSplitView;
@@ -104,6 +143,7 @@ private:
 	BMenuItem*		fMenuPaste;
 	BMenuItem*		fMenuClearFav;
 	BMenuItem*		fMenuPauseFading;
+	BMenuItem*		fMenuFuzzyFilter;
 
 	EditWindow*		fEditWindow;
 };
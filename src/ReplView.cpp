@@ -7,6 +7,9 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include <AboutWindow.h>
 #include <Application.h>
@@ -28,6 +31,10 @@
 #define B_TRANSLATION_CONTEXT "ClipboardMonitor"
 
 
+// Only the start of the first line of the clip gets shown
+static const ssize_t kMaxLineLength = 1024;
+
+
 ReplView::ReplView()
 	:
 	BView(B_TRANSLATE("Clipboard monitor"), B_WILL_DRAW | B_FULL_UPDATE_ON_RESIZE),
@@ -102,7 +109,7 @@ ReplView::AttachedToWindow()
 {
 	BView::AttachedToWindow();
 
-	fCurrentClip = _GetClipboard().String();
+	fCurrentClip = _GetClipboard();
 	TruncateClip(Bounds().Width() - 7); // respect dragger width
 
 	be_clipboard->StartWatching(this);
@@ -133,7 +140,7 @@ ReplView::MessageReceived(BMessage* msg)
 	switch (msg->what) {
 		case B_CLIPBOARD_CHANGED:
 		{
-			fCurrentClip = _GetClipboard().String();
+			fCurrentClip = _GetClipboard();
 			if (fCurrentClip.Length() == 0)
 				break;
 
@@ -168,23 +175,6 @@ void
 ReplView::TruncateClip(float width)
 {
 	BString clip(fCurrentClip);
-
-	// Remove spaces, tabs. empty lines from beginning of clip
-	while (true) {
-		if (clip.StartsWith(" "))
-			clip.Remove(0, 1);
-		else if (clip.StartsWith("\t"))
-			clip.Remove(0, 1);
-		else if (clip.StartsWith("\n"))
-			clip.Remove(0, 1);
-		else
-			break;
-	}
-	// Remove all but the first line
-	int32 newline = clip.FindFirst("\n");
-	if (newline >= 0)
-		clip.Remove(newline, clip.Length());
-
 	static const float spacing = be_control_look->DefaultLabelSpacing();
 	TruncateString(&clip, B_TRUNCATE_END, width - spacing * 5);
 	fContentsView->SetText(clip);
@@ -198,20 +188,44 @@ ReplView::_GetClipboard()
 	ssize_t textLen;
 	BMessage* clipboard = (BMessage*)NULL;
 
+	// Only the first line is shown, so only that is copied, and while the
+	// clipboard is locked, as the data belongs to it.
+	BString clip;
 	if (be_clipboard->Lock()) {
-		if ((clipboard = be_clipboard->Data()))
-			clipboard->FindData("text/plain", B_MIME_TYPE, (const void**)&text, &textLen);
+		if ((clipboard = be_clipboard->Data())
+			&& clipboard->FindData("text/plain", B_MIME_TYPE,
+				(const void**)&text, &textLen) == B_OK)
+			clip = _FirstLine(text, textLen);
 		be_clipboard->Unlock();
 	}
-	if (text == NULL) {
-		text = B_TRANSLATE("-= No text in clipboard =-");
-		textLen = strlen(text);
-	}
-	BString clip(text, textLen);
+	if (text == NULL)
+		clip = B_TRANSLATE("-= No text in clipboard =-");
 	return clip;
 }
 
 
+/*static*/ BString
+ReplView::_FirstLine(const char* text, ssize_t length)
+{
+	// Skip spaces, tabs and empty lines at the beginning
+	const char* end = text + length;
+	while (text < end && (*text == ' ' || *text == '\t' || *text == '\n'))
+		text++;
+
+	// Way more than fits into the view
+	length = std::min(end - text, (ssize_t)kMaxLineLength);
+	const char* newline = (const char*)memchr(text, '\n', length);
+	if (newline != NULL)
+		length = newline - text;
+	else if (text + length < end) {
+		// Don't cut a UTF-8 character in half
+		while (length > 0 && (text[length] & 0xc0) == 0x80)
+			length--;
+	}
+	return BString(text, length);
+}
+
+
 void
 ReplView::_LaunchClipdinger(BMessage* msg)
 {
@@ -32,6 +32,7 @@ public:
 
 private:
 	BString					_GetClipboard();
+	static BString			_FirstLine(const char* text, ssize_t length);
 	void					_LaunchClipdinger(BMessage* msg);
 	static filter_result	_MessageFilter(BMessage* msg,
 								BHandler** target, BMessageFilter* filter);
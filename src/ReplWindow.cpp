@@ -17,6 +17,7 @@
 #include "Constants.h"
 #include "ReplView.h"
 #include "ReplWindow.h"
+#include "Tracing.h"
 
 #undef B_TRANSLATION_CONTEXT
 #define B_TRANSLATION_CONTEXT "ReplWindow"
@@ -27,6 +28,8 @@ ReplWindow::ReplWindow(BRect frame)
 	BWindow(BRect(0, 0, 350, 100), B_TRANSLATE("Clipboard monitor"), B_TITLED_WINDOW,
 		B_NOT_ZOOMABLE | B_AUTO_UPDATE_SIZE_LIMITS | B_CLOSE_ON_ESCAPE, B_ALL_WORKSPACES)
 {
+	TRACE_SPAN("ReplWindow::ReplWindow");
+
 	_BuildLayout();
 
 	frame.OffsetBy(40.0, 90.0);
@@ -51,6 +54,8 @@ ReplWindow::FrameResized(float width, float height)
 void
 ReplWindow::MessageReceived(BMessage* message)
 {
+	TRACE_MESSAGE("ReplWindow::MessageReceived", message->what);
+
 	switch (message->what) {
 		default:
 		{
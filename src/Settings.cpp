@@ -8,7 +8,6 @@
 
 #include <Application.h>
 #include <Directory.h>
-#include <File.h>
 #include <FindDirectory.h>
 #include <Font.h>
 #include <Message.h>
@@ -17,13 +16,44 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <string>
+
 #include "Constants.h"
+#include "MappedFile.h"
+#include "RecordFile.h"
 #include "Settings.h"
 
 
+// Settings are a flattened BMessage in a record. Older versions saved the
+// bare BMessage.
+static status_t
+unflatten_settings(const char* path, BMessage& msg)
+{
+	MappedFile file(path);
+	if (file.InitCheck() != B_OK)
+		return file.InitCheck();
+
+	RecordScanner scanner(file.Data(), file.Size());
+	uint32 type;
+	const char* data;
+	uint32 size;
+	bool found = false;
+	while (scanner.Next(type, data, size)) {
+		found = true;
+		if (type == kSettingsRecord && msg.Unflatten(data) == B_OK)
+			return B_OK;
+	}
+	if (found)
+		return B_BAD_DATA;
+
+	return msg.Unflatten(file.Data());
+}
+
+
 Settings::Settings()
 	:
 	fLimit(kDefaultLimit),
+	fSizeLimit(kDefaultSizeLimit),
 	fTrayIcon(kDefaultTrayIcon),
 	fAutoStart(kDefaultAutoStart),
 	fAutoPaste(kDefaultAutoPaste),
@@ -32,6 +62,7 @@ Settings::Settings()
 	fFadeStep(kDefaultFadeStep),
 	fFadeMaxLevel(kDefaultFadeMaxLevel),
 	fFadePause(0),
+	fFuzzyFilter(false),
 	fPosition(-1, -1, -1, -1),
 	fLeftWeight(0.8),
 	fRightWeight(0.2),
@@ -61,13 +92,15 @@ Settings::LoadSettings()
 		status_t ret = path.Append(kSettingsFolder);
 		if (ret == B_OK) {
 			path.Append(kSettingsFile);
-			BFile file(path.Path(), B_READ_ONLY);
 
-			if ((file.InitCheck() == B_OK) && (msg.Unflatten(&file) == B_OK)) {
+			if (unflatten_settings(path.Path(), msg) == B_OK) {
 				if (msg.FindInt32("limit", &fLimit) != B_OK) {
 					fLimit = kDefaultLimit;
 					dirtySettings = true;
 				}
+				if (msg.FindInt32("sizelimit", &fSizeLimit) != B_OK)
+					fSizeLimit = kDefaultSizeLimit;
+
 				if (msg.FindBool("trayicon", &fTrayIcon) != B_OK) {
 					fTrayIcon = kDefaultTrayIcon;
 					dirtySettings = true;
@@ -96,6 +129,9 @@ Settings::LoadSettings()
 					fFadeStep = kDefaultFadeMaxLevel;
 					dirtySettings = true;
 				}
+				if (msg.FindBool("fuzzyfilter", &fFuzzyFilter) != B_OK)
+					fFuzzyFilter = false;
+
 				if (msg.FindRect("windowlocation", &fPosition) != B_OK)
 					fPosition.Set(-1, -1, -1, -1);
 
@@ -136,24 +172,31 @@ Settings::SaveSettings()
 		path.Append(kSettingsFile);
 
 	if (ret == B_OK) {
-		BFile file(path.Path(), B_WRITE_ONLY | B_CREATE_FILE);
-		ret = file.InitCheck();
-
-		if (ret == B_OK) {
-			msg.AddInt32("limit", fLimit);
-			msg.AddBool("trayicon", fTrayIcon);
-			msg.AddBool("autostart", fAutoStart);
-			msg.AddInt32("autopaste", fAutoPaste);
-			msg.AddInt32("fade", fFade);
-			msg.AddInt32("fadedelay", fFadeDelay);
-			msg.AddInt32("fadestep", fFadeStep);
-			msg.AddInt32("fademax", fFadeMaxLevel);
-			msg.AddRect("windowlocation", fPosition);
-			msg.AddFloat("split_weight_left", fLeftWeight);
-			msg.AddFloat("split_weight_right", fRightWeight);
-			msg.AddBool("split_collapse_left", fLeftCollapse);
-			msg.AddBool("split_collapse_right", fRightCollapse);
-			msg.Flatten(&file);
+		msg.AddInt32("limit", fLimit);
+		msg.AddInt32("sizelimit", fSizeLimit);
+		msg.AddBool("trayicon", fTrayIcon);
+		msg.AddBool("autostart", fAutoStart);
+		msg.AddInt32("autopaste", fAutoPaste);
+		msg.AddInt32("fade", fFade);
+		msg.AddInt32("fadedelay", fFadeDelay);
+		msg.AddInt32("fadestep", fFadeStep);
+		msg.AddInt32("fademax", fFadeMaxLevel);
+		msg.AddBool("fuzzyfilter", fFuzzyFilter);
+		msg.AddRect("windowlocation", fPosition);
+		msg.AddFloat("split_weight_left", fLeftWeight);
+		msg.AddFloat("split_weight_right", fRightWeight);
+		msg.AddBool("split_collapse_left", fLeftCollapse);
+		msg.AddBool("split_collapse_right", fRightCollapse);
+
+		// Replaced atomically, a crash leaves the old settings
+		std::string flattened(msg.FlattenedSize(), '\0');
+		if (msg.Flatten(&flattened[0], flattened.length()) == B_OK) {
+			std::string data;
+			RecordWriter writer(data);
+			writer.StartRecord(kSettingsRecord);
+			writer.PutRaw(flattened.data(), flattened.length());
+			writer.EndRecord();
+			write_file_atomically(path.Path(), data.data(), data.length());
 		}
 	}
 }
@@ -199,6 +242,16 @@ Settings::SetLimit(int32 limit)
 }
 
 
+void
+Settings::SetSizeLimit(int32 megabytes)
+{
+	if (fSizeLimit == megabytes)
+		return;
+	fSizeLimit = megabytes;
+	dirtySettings = true;
+}
+
+
 void
 Settings::SetTrayIcon(int32 trayicon)
 {
@@ -269,6 +322,16 @@ Settings::SetFadeMaxLevel(int32 level)
 }
 
 
+void
+Settings::SetFuzzyFilter(bool fuzzy)
+{
+	if (fFuzzyFilter == fuzzy)
+		return;
+	fFuzzyFilter = fuzzy;
+	dirtySettings = true;
+}
+
+
 void
 Settings::SetWindowPosition(BRect where)
 {
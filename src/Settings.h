@@ -24,6 +24,7 @@ public:
 		void		SaveSettings();
 
 		int32		GetLimit() { return fLimit; }
+		int32		GetSizeLimit() { return fSizeLimit; }
 		bool		GetAutoStart() { return fAutoStart; }
 		bool		GetTrayIcon() { return fTrayIcon; }
 		int32		GetAutoPaste() { return fAutoPaste; }
@@ -32,12 +33,14 @@ public:
 		int32		GetFadeStep() { return fFadeStep; }
 		int32		GetFadeMaxLevel() { return fFadeMaxLevel; }
 		int32		GetFadePause() { return fFadePause; }
+		bool		GetFuzzyFilter() { return fFuzzyFilter; }
 
 		BRect		GetWindowPosition() { return fPosition; }
 		void		GetSplitWeight(float& left, float& right);
 		void		GetSplitCollapse(bool& left, bool& right);
 
 		void		SetLimit(int32 limit);
+		void		SetSizeLimit(int32 megabytes);
 		void		SetTrayIcon(int32 autostart);
 		void		SetAutoStart(int32 autostart);
 		void		SetAutoPaste(int32 autopaste);
@@ -49,8 +52,10 @@ public:
 		void		SetSplitWeight(float left, float right);
 		void		SetSplitCollapse(bool left, bool right);
 		void		SetFadePause(int32 pause) { fFadePause = pause; }
+		void		SetFuzzyFilter(bool fuzzy);
 private:
 		int32		fLimit;
+		int32		fSizeLimit;
 		bool		fTrayIcon;
 		bool		fAutoStart;
 
@@ -60,6 +65,7 @@ private:
 		int32		fFadeStep;
 		int32		fFadeMaxLevel;
 		int32		fFadePause;
+		bool		fFuzzyFilter;
 
 		BRect		fPosition;
 		float		fLeftWeight;
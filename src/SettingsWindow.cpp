@@ -19,6 +19,7 @@
 #include "App.h"
 #include "Constants.h"
 #include "SettingsWindow.h"
+#include "Tracing.h"
 
 #include <stdio.h>
 #undef B_TRANSLATION_CONTEXT
@@ -30,6 +31,8 @@ SettingsWindow::SettingsWindow(BRect frame)
 	BWindow(BRect(), B_TRANSLATE("Clipdinger settings"), B_TITLED_WINDOW,
 		B_NOT_ZOOMABLE | B_NOT_RESIZABLE | B_AUTO_UPDATE_SIZE_LIMITS, B_ALL_WORKSPACES)
 {
+	TRACE_SPAN("SettingsWindow::SettingsWindow");
+
 	_BuildLayout();
 	_GetSettings();
 	_UpdateControls();
@@ -61,6 +64,8 @@ SettingsWindow::DispatchMessage(BMessage* message, BHandler* handler)
 void
 SettingsWindow::MessageReceived(BMessage* message)
 {
+	TRACE_MESSAGE("SettingsWindow::MessageReceived", message->what);
+
 	Settings* settings = my_app->GetSettings();
 
 	switch (message->what) {
@@ -148,9 +153,11 @@ SettingsWindow::MessageReceived(BMessage* message)
 				newLimit = 1; // History has to be at least 1 deep.
 				fLimitControl->SetText("1");
 			}
+			newSizeLimit = atoi(fSizeLimitControl->Text());
 
 			if (settings->Lock()) {
 				settings->SetLimit(newLimit);
+				settings->SetSizeLimit(newSizeLimit);
 				settings->SetTrayIcon(newTrayIcon);
 				settings->SetAutoStart(newAutoStart);
 				settings->SetAutoPaste(newAutoPaste);
@@ -216,6 +223,17 @@ SettingsWindow::_BuildLayout()
 	BStringView* limitlabel
 		= new BStringView("limitlabel", B_TRANSLATE("entries in the clipboard history"));
 
+	// Size limit
+	fSizeLimitControl = new BTextControl("sizelimitfield", NULL, "", NULL);
+	fSizeLimitControl->SetAlignment(B_ALIGN_CENTER, B_ALIGN_CENTER);
+	for (uint32 i = 0; i < '0'; i++)
+		fSizeLimitControl->TextView()->DisallowChar(i);
+	for (uint32 i = '9' + 1; i < 255; i++)
+		fSizeLimitControl->TextView()->DisallowChar(i);
+
+	BStringView* sizelimitlabel = new BStringView("sizelimitlabel",
+		B_TRANSLATE("MB of clips at most (0 for no limit)"));
+
 	// Tray icon
 	fTrayIconBox = new BCheckBox(
 		"trayicon", B_TRANSLATE("Show icon in Deskbar tray"), new BMessage(TRAYICON));
@@ -277,6 +295,12 @@ SettingsWindow::_BuildLayout()
 			.Add(limitlabel)
 			.Add(BSpaceLayoutItem::CreateHorizontalStrut(spacing * 4))
 			.End()
+		.AddGroup(B_HORIZONTAL)
+			.SetInsets(spacing, 0, spacing, 0)
+			.Add(fSizeLimitControl)
+			.Add(sizelimitlabel)
+			.Add(BSpaceLayoutItem::CreateHorizontalStrut(spacing * 4))
+			.End()
 		.AddGroup(B_VERTICAL, 0)
 			.SetInsets(spacing, 0, spacing, 0)
 			.Add(fTrayIconBox)
@@ -358,6 +382,9 @@ SettingsWindow::_UpdateControls()
 	char string[4];
 	snprintf(string, sizeof(string), "%" B_PRId32, originalLimit);
 	fLimitControl->SetText(string);
+	char sizeString[12];
+	snprintf(sizeString, sizeof(sizeString), "%" B_PRId32, originalSizeLimit);
+	fSizeLimitControl->SetText(sizeString);
 	fTrayIconBox->SetValue(originalTrayIcon);
 	if (originalTrayIcon)
 		_AddIconToDeskbar();
@@ -416,6 +443,7 @@ SettingsWindow::_UpdateMainWindow()
 	BMessenger messenger(my_app->fMainWindow);
 	BMessage message(UPDATE_SETTINGS);
 	message.AddInt32("limit", newLimit);
+	message.AddInt32("sizelimit", newSizeLimit);
 	message.AddInt32("autopaste", newAutoPaste);
 	message.AddInt32("fade", newFade);
 	messenger.SendMessage(&message);
@@ -431,6 +459,7 @@ SettingsWindow::_GetSettings()
 	Settings* settings = my_app->GetSettings();
 	if (settings->Lock()) {
 		newLimit = originalLimit = settings->GetLimit();
+		newSizeLimit = originalSizeLimit = settings->GetSizeLimit();
 		newTrayIcon = originalTrayIcon = settings->GetTrayIcon();
 		newAutoStart = originalAutoStart = settings->GetAutoStart();
 		newAutoPaste = originalAutoPaste = settings->GetAutoPaste();
@@ -449,6 +478,7 @@ SettingsWindow::_RevertSettings()
 	Settings* settings = my_app->GetSettings();
 	if (settings->Lock()) {
 		settings->SetLimit(originalLimit);
+		settings->SetSizeLimit(originalSizeLimit);
 		settings->SetTrayIcon(originalTrayIcon);
 		settings->SetAutoStart(originalAutoStart);
 		settings->SetAutoPaste(originalAutoPaste);
@@ -459,6 +489,7 @@ SettingsWindow::_RevertSettings()
 		settings->Unlock();
 	}
 	newLimit = originalLimit;
+	newSizeLimit = originalSizeLimit;
 	newAutoStart = originalTrayIcon;
 	newAutoStart = originalAutoStart;
 	newAutoPaste = originalAutoPaste;
@@ -38,6 +38,7 @@ private:
 	void			_RevertSettings();
 
 	BTextControl*	fLimitControl;
+	BTextControl*	fSizeLimitControl;
 	BCheckBox*		fFadeBox;
 	BCheckBox*		fTrayIconBox;
 	BCheckBox*		fAutoStartBox;
@@ -49,6 +50,7 @@ private:
 	BString*		fFadeDescription;
 
 	int32			originalLimit;
+	int32			originalSizeLimit;
 	int32			originalTrayIcon;
 	int32			originalAutoStart;
 	int32			originalAutoPaste;
@@ -58,6 +60,7 @@ private:
 	int32			originalFadeMaxLevel;
 
 	int32			newLimit;
+	int32			newSizeLimit;
 	int32			newTrayIcon;
 	int32			newAutoStart;
 	int32			newAutoPaste;
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include "BlobStore.h"
+#include "Instrumentation.h"
+#include "RecordFile.h"
+
+
+BlobStore::BlobStore()
+	:
+	fThreshold(kDefaultBlobThreshold),
+	fWriter(NULL)
+{
+}
+
+
+status_t
+BlobStore::SetTo(const char* directory, size_t threshold)
+{
+	fDirectory.clear();
+	if (mkdir(directory, 0755) != 0 && errno != EEXIST)
+		return B_IO_ERROR;
+
+	fDirectory = directory;
+	fThreshold = threshold;
+	return B_OK;
+}
+
+
+status_t
+BlobStore::Store(uint64 hash, const char* data, size_t length)
+{
+	if (!IsValid())
+		return B_ERROR;
+
+	// Blobs are never changed, the same hash means the same contents
+	std::string path = _PathFor(hash);
+	struct stat st;
+	if (stat(path.c_str(), &st) == 0 && (size_t)st.st_size == length)
+		return B_OK;
+
+	// Synced before the journal can refer to it. The writer writes it
+	// before the journal records that come after.
+	if (fWriter != NULL) {
+		INSTRUMENT_COPY(length);
+		fWriter->Replace(path, std::string(data, length));
+		return B_OK;
+	}
+	return write_file_atomically(path.c_str(), data, length);
+}
+
+
+std::shared_ptr<MappedFile>
+BlobStore::Map(uint64 hash) const
+{
+	if (!IsValid())
+		return std::shared_ptr<MappedFile>();
+
+	std::shared_ptr<MappedFile> mapping(new MappedFile(_PathFor(hash).c_str()));
+	if (mapping->InitCheck() != B_OK)
+		return std::shared_ptr<MappedFile>();
+
+	return mapping;
+}
+
+
+void
+BlobStore::Remove(uint64 hash)
+{
+	// A mapping of it stays valid
+	if (IsValid())
+		remove(_PathFor(hash).c_str());
+}
+
+
+void
+BlobStore::RemoveAllExcept(const std::unordered_set<uint64>& keep)
+{
+	if (!IsValid())
+		return;
+
+	DIR* dir = opendir(fDirectory.c_str());
+	if (dir == NULL)
+		return;
+
+	while (struct dirent* entry = readdir(dir)) {
+		// Also catches temporary files of interrupted writes
+		char* end;
+		uint64 hash = strtoull(entry->d_name, &end, 16);
+		if (entry->d_name[0] == '.' || (*end == '\0' && keep.count(hash) > 0))
+			continue;
+
+		remove((fDirectory + "/" + entry->d_name).c_str());
+	}
+	closedir(dir);
+}
+
+
+std::string
+BlobStore::_PathFor(uint64 hash) const
+{
+	char name[20];
+	snprintf(name, sizeof(name), "%016" PRIx64, hash);
+	return fDirectory + "/" + name;
+}
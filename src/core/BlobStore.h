@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Keeps large clips in a directory of their own, one file per clip, named
+ * after the clip's hash. The history then only holds a mapping of the file
+ * and a short preview, the contents get paged in when they're needed,
+ * e.g. for pasting or filtering, and can be dropped again by the system.
+ */
+
+#ifndef BLOBSTORE_H
+#define BLOBSTORE_H
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "CoreDefs.h"
+#include "FileWriter.h"
+#include "MappedFile.h"
+
+
+// Clips from this size on are stored as blobs
+static const size_t kDefaultBlobThreshold = 64 * 1024;
+
+
+class BlobStore {
+public:
+						BlobStore();
+
+	// Creates the directory if needed
+	status_t			SetTo(const char* directory,
+							size_t threshold = kDefaultBlobThreshold);
+	bool				IsValid() const { return !fDirectory.empty(); }
+	// Blobs are written by 'writer' from now on, instead of right away.
+	// Until it's done, Map() doesn't find them.
+	void				SetWriter(FileWriter* writer) { fWriter = writer; }
+
+	bool				ShouldStore(size_t length) const
+							{ return IsValid() && length >= fThreshold; }
+
+	// Writes the blob, unless there already is one with this hash
+	status_t			Store(uint64 hash, const char* data, size_t length);
+	// NULL if there's no such blob
+	std::shared_ptr<MappedFile> Map(uint64 hash) const;
+	void				Remove(uint64 hash);
+	// Removes blobs left behind, e.g. after a crash
+	void				RemoveAllExcept(const std::unordered_set<uint64>& keep);
+
+private:
+	std::string			_PathFor(uint64 hash) const;
+
+	std::string			fDirectory;
+	size_t				fThreshold;
+	FileWriter*			fWriter;
+};
+
+#endif // BLOBSTORE_H
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <atomic>
+
+#include <string.h>
+
+#include "ClipBuffer.h"
+#include "ClipHash.h"
+#include "Instrumentation.h"
+
+
+static std::atomic<int64> sAllocations(0);
+static std::atomic<int64> sBytesCopied(0);
+static std::atomic<int64> sLiveBuffers(0);
+static std::atomic<int64> sLiveBytes(0);
+
+
+ClipBuffer::ClipBuffer(const char* data, size_t length)
+	:
+	fData(new char[length > 0 ? length : 1]),
+	fLength(length)
+{
+	memcpy(fData, data, length);
+	fHash = hash_clip(fData, fLength);
+
+	INSTRUMENT_COPY(length);
+	sAllocations++;
+	sBytesCopied += length;
+	sLiveBuffers++;
+	sLiveBytes += length;
+}
+
+
+ClipBuffer::~ClipBuffer()
+{
+	sLiveBuffers--;
+	sLiveBytes -= fLength;
+	delete[] fData;
+}
+
+
+/*static*/ ClipBufferRef
+ClipBuffer::Create(const char* data, size_t length)
+{
+	return ClipBufferRef(new ClipBuffer(data, length));
+}
+
+
+/*static*/ void
+ClipBuffer::GetStats(clip_buffer_stats& stats)
+{
+	stats.allocations = sAllocations;
+	stats.bytes_copied = sBytesCopied;
+	stats.live_buffers = sLiveBuffers;
+	stats.live_bytes = sLiveBytes;
+}
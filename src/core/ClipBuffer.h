@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * The immutable bytes of a new clip. They're copied once out of the
+ * clipboard and then shared, by reference, by everyone who needs them,
+ * e.g. the ClipStore and its records.
+ */
+
+#ifndef CLIPBUFFER_H
+#define CLIPBUFFER_H
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "CoreDefs.h"
+
+
+struct clip_buffer_stats {
+	int64		allocations;
+	int64		bytes_copied;
+	int64		live_buffers;
+	int64		live_bytes;
+};
+
+
+class ClipBuffer;
+typedef std::shared_ptr<const ClipBuffer> ClipBufferRef;
+
+
+class ClipBuffer {
+public:
+						~ClipBuffer();
+
+	// The only place where clip bytes are copied
+	static	ClipBufferRef Create(const char* data, size_t length);
+
+	const char*			Data() const { return fData; }
+	size_t				Length() const { return fLength; }
+	// hash_clip() of the bytes, computed once
+	uint64				Hash() const { return fHash; }
+
+	static	void		GetStats(clip_buffer_stats& stats);
+
+private:
+						ClipBuffer(const char* data, size_t length);
+						ClipBuffer(const ClipBuffer&);
+			ClipBuffer&	operator=(const ClipBuffer&);
+
+	char*				fData;
+	size_t				fLength;
+	uint64				fHash;
+};
+
+#endif // CLIPBUFFER_H
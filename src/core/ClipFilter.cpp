@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "ClipFilter.h"
+#include "Tracing.h"
+
+
+static const std::string kEmptyQuery;
+
+
+ClipFilter::ClipFilter(const ClipStore& store)
+	:
+	fStore(store),
+	fGeneration(store.Generation()),
+	fScanAll(false),
+	fNext(0),
+	fDone(true)
+{
+}
+
+
+ClipFilter::~ClipFilter()
+{
+}
+
+
+bool
+ClipFilter::SetQuery(const char* query)
+{
+	TRACE_SPAN("ClipFilter::SetQuery");
+
+	bool narrowed = Begin(query);
+	while (!Step(INT32_MAX))
+		;
+	return narrowed;
+}
+
+
+bool
+ClipFilter::Begin(const char* query)
+{
+	if (fGeneration != fStore.Generation()) {
+		// indexes are stale
+		fResults.clear();
+		fDone = true;
+		fGeneration = fStore.Generation();
+	}
+
+	// An unfinished result isn't worth caching
+	if (!fDone) {
+		fResults.pop_back();
+		fDone = true;
+	}
+
+	fMatcher.SetTo(query);
+	const std::string& folded = fMatcher.Folded();
+
+	bool narrowed = !fResults.empty()
+		&& folded.find(fResults.back().query) != std::string::npos;
+
+	// Drop cached results that don't lead up to the new query
+	while (!fResults.empty()
+		&& folded.find(fResults.back().query) == std::string::npos)
+		fResults.pop_back();
+
+	if (!fResults.empty() && fResults.back().query == folded)
+		return narrowed;
+
+	fResults.push_back(Result());
+	fResults.back().query = folded;
+	fCandidates.clear();
+	fScanAll = fResults.size() == 1
+		&& !fStore.FindCandidates(folded.c_str(), fCandidates);
+	fNext = 0;
+	fDone = false;
+
+	return narrowed;
+}
+
+
+bool
+ClipFilter::Step(int32 count)
+{
+	if (fDone)
+		return true;
+
+	// When narrowing, just the previous matches are checked again
+	const std::vector<int32>& candidates = fResults.size() > 1
+		? fResults[fResults.size() - 2].matches : fCandidates;
+	int32 total = fScanAll ? fStore.CountClips() : (int32)candidates.size();
+	int32 end = fNext + std::min(count, total - fNext);
+
+	std::vector<int32>& matches = fResults.back().matches;
+	for (; fNext < end; fNext++) {
+		int32 index = fScanAll ? fNext : candidates[fNext];
+		const ClipRecord* record = fStore.ClipAt(index);
+		if (fMatcher.Matches(record->GetClipData(), record->GetClipLength()))
+			matches.push_back(index);
+	}
+
+	fDone = fNext >= total;
+	return fDone;
+}
+
+
+bool
+ClipFilter::Finish(ParallelSearch& search,
+	const ParallelSearch::CancelFunction& cancelled,
+	const ParallelSearch::ProgressFunction& progress)
+{
+	if (fDone)
+		return true;
+
+	const std::vector<int32>& candidates = fResults.size() > 1
+		? fResults[fResults.size() - 2].matches : fCandidates;
+	int32 total = fScanAll ? fStore.CountClips() : (int32)candidates.size();
+	int32 first = fNext;
+	bool scanAll = fScanAll;
+	const ClipStore& store = fStore;
+	const TextMatcher& matcher = fMatcher;
+
+	bool finished = search.Run(total - first,
+		[&](int32 item) -> int32 {
+			int32 index = scanAll ? first + item : candidates[first + item];
+			const ClipRecord* record = store.ClipAt(index);
+			return matcher.Matches(record->GetClipData(),
+				record->GetClipLength()) ? index : -1;
+		}, cancelled, progress, fResults.back().matches);
+
+	if (!finished) {
+		fResults.pop_back();
+		fDone = true;
+		return false;
+	}
+
+	fNext = total;
+	fDone = true;
+	return true;
+}
+
+
+const std::string&
+ClipFilter::Query() const
+{
+	return fResults.empty() ? kEmptyQuery : fResults.back().query;
+}
+
+
+void
+ClipFilter::Reset()
+{
+	fResults.clear();
+	fDone = true;
+}
+
+
+const std::vector<int32>&
+ClipFilter::Matches() const
+{
+	return fResults.empty() ? fNoMatches : fResults.back().matches;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Case-insensitive substring filter over a ClipStore that works
+ * incrementally: a query containing the previous one only re-checks the
+ * previous matches, and going back to a shorter query reuses the result
+ * that was cached for it. Begin() and Step() do the same bit by bit, so
+ * the work can be spread out and given up on (see FilterWorker), or
+ * Finish() spreads it over all cores.
+ */
+
+#ifndef CLIPFILTER_H
+#define CLIPFILTER_H
+
+#include <string>
+#include <vector>
+
+#include "ClipStore.h"
+#include "ParallelSearch.h"
+#include "TextSearch.h"
+
+
+class ClipFilter {
+public:
+						ClipFilter(const ClipStore& store);
+						~ClipFilter();
+
+	// Updates the matches for the new query. Returns true if they are a
+	// subset of the previous matches.
+	bool				SetQuery(const char* query);
+	// Like SetQuery(), but only prepares the work, Step() does it. Until
+	// it's done, Matches() are the ones found so far, and beginning
+	// another query drops them.
+	bool				Begin(const char* query);
+	// Checks up to 'count' more clips, returns true once all are checked
+	bool				Step(int32 count);
+	// Checks the rest of the clips on the threads of 'search', see
+	// ParallelSearch::Run(). If it gets cancelled, the unfinished result
+	// is dropped and false is returned.
+	bool				Finish(ParallelSearch& search,
+							const ParallelSearch::CancelFunction& cancelled,
+							const ParallelSearch::ProgressFunction& progress);
+	bool				IsDone() const { return fDone; }
+	// The case folded current query
+	const std::string&	Query() const;
+	void				Reset();
+
+	// Store indexes of the matching clips, in ascending order
+	const std::vector<int32>& Matches() const;
+
+private:
+	struct Result {
+		std::string			query;		// Case folded
+		std::vector<int32>	matches;
+	};
+
+
+	const ClipStore&	fStore;
+	uint32				fGeneration;
+	// Each cached query contains the one before, the last is the current
+	std::vector<Result>	fResults;
+	std::vector<int32>	fNoMatches;
+
+	// The query in progress, see Begin()
+	TextMatcher			fMatcher;
+	// From the trigram index, unless narrowing the previous result
+	std::vector<int32>	fCandidates;
+	bool				fScanAll;
+	int32				fNext;
+	bool				fDone;
+};
+
+#endif // CLIPFILTER_H
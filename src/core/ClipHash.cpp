@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * A simple multiply-rotate hash in the style of xxHash64. It consumes 32
+ * bytes per round in four independent lanes, so large clips hash at
+ * memory speed.
+ */
+
+#include <string.h>
+
+#include "ClipHash.h"
+
+
+static const uint64 kPrime1 = 0x9E3779B185EBCA87ULL;
+static const uint64 kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64 kPrime3 = 0x165667B19E3779F9ULL;
+static const uint64 kPrime4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64 kPrime5 = 0x27D4EB2F165667C5ULL;
+
+
+static inline uint64
+rotate_left(uint64 value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+
+static inline uint64
+read64(const uint8* data)
+{
+	uint64 value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+
+static inline uint32
+read32(const uint8* data)
+{
+	uint32 value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+
+static inline uint64
+hash_round(uint64 accumulator, uint64 input)
+{
+	accumulator += input * kPrime2;
+	accumulator = rotate_left(accumulator, 31);
+	return accumulator * kPrime1;
+}
+
+
+static inline uint64
+merge_round(uint64 accumulator, uint64 value)
+{
+	accumulator ^= hash_round(0, value);
+	return accumulator * kPrime1 + kPrime4;
+}
+
+
+uint64
+hash_clip(const void* data, size_t length)
+{
+	const uint8* input = (const uint8*)data;
+	const uint8* end = input + length;
+	uint64 hash;
+
+	if (length >= 32) {
+		const uint8* limit = end - 32;
+		uint64 lane1 = kPrime1 + kPrime2;
+		uint64 lane2 = kPrime2;
+		uint64 lane3 = 0;
+		uint64 lane4 = 0 - kPrime1;
+
+		do {
+			lane1 = hash_round(lane1, read64(input));
+			lane2 = hash_round(lane2, read64(input + 8));
+			lane3 = hash_round(lane3, read64(input + 16));
+			lane4 = hash_round(lane4, read64(input + 24));
+			input += 32;
+		} while (input <= limit);
+
+		hash = rotate_left(lane1, 1) + rotate_left(lane2, 7)
+			+ rotate_left(lane3, 12) + rotate_left(lane4, 18);
+		hash = merge_round(hash, lane1);
+		hash = merge_round(hash, lane2);
+		hash = merge_round(hash, lane3);
+		hash = merge_round(hash, lane4);
+	} else
+		hash = kPrime5;
+
+	hash += (uint64)length;
+
+	while (input + 8 <= end) {
+		hash ^= hash_round(0, read64(input));
+		hash = rotate_left(hash, 27) * kPrime1 + kPrime4;
+		input += 8;
+	}
+	if (input + 4 <= end) {
+		hash ^= (uint64)read32(input) * kPrime1;
+		hash = rotate_left(hash, 23) * kPrime2 + kPrime3;
+		input += 4;
+	}
+	while (input < end) {
+		hash ^= (*input) * kPrime5;
+		hash = rotate_left(hash, 11) * kPrime1;
+		input++;
+	}
+
+	hash ^= hash >> 33;
+	hash *= kPrime2;
+	hash ^= hash >> 29;
+	hash *= kPrime3;
+	hash ^= hash >> 32;
+	return hash;
+}
@@ -0,0 +1,18 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#ifndef CLIPHASH_H
+#define CLIPHASH_H
+
+#include <stddef.h>
+
+#include "CoreDefs.h"
+
+
+// Fast non-cryptographic 64-bit hash of the clip contents, used to find
+// duplicate clips without comparing every clip body.
+uint64	hash_clip(const void* data, size_t length);
+
+#endif // CLIPHASH_H
@@ -0,0 +1,678 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <string.h>
+
+#include "ClipHash.h"
+#include "ClipStore.h"
+#include "Instrumentation.h"
+#include "RecordFile.h"
+#include "Tracing.h"
+
+
+// Only the oldest clips are considered for eviction, so that picking one
+// doesn't depend on the length of the history.
+static const int32 kEvictionWindow = 32;
+// Even empty clips take up some memory
+static const uint64 kRecordOverhead = 128;
+
+
+static size_t
+preview_length(const char* clip, size_t length)
+{
+	if (length <= kPreviewLength)
+		return length;
+
+	// Don't cut a UTF-8 character in half
+	length = kPreviewLength;
+	while (length > 0 && (clip[length] & 0xc0) == 0x80)
+		length--;
+	return length;
+}
+
+
+ClipRecord::ClipRecord(const ClipBufferRef& clip, const std::string& title,
+	const std::string& origin, bigtime_t added, bigtime_t since)
+	:
+	fBuffer(clip),
+	fData(clip->Data()),
+	fLength(clip->Length()),
+	fOrigin(origin),
+	fTimeAdded(added),
+	fTimeSince(since),
+	fId(0),
+	fSerial(0),
+	fHash(clip->Hash()),
+	fBlob(false),
+	fPasted(false)
+{
+	SetTitle(title);
+}
+
+
+ClipRecord::ClipRecord(const std::shared_ptr<MappedFile>& mapping,
+	const char* clip, size_t length, uint64 hash, const std::string& title,
+	const std::string& origin, bigtime_t added, bigtime_t since)
+	:
+	fMapping(mapping),
+	fData(clip),
+	fLength(length),
+	fTitle(title),
+	fOrigin(origin),
+	fTimeAdded(added),
+	fTimeSince(since),
+	fId(0),
+	fSerial(0),
+	fHash(hash),
+	fBlob(false),
+	fPasted(false)
+{
+}
+
+
+ClipRecord::ClipRecord(const std::shared_ptr<MappedFile>& blob, uint64 hash,
+	const std::string& preview, const std::string& title,
+	const std::string& origin, bigtime_t added, bigtime_t since)
+	:
+	fMapping(blob),
+	fPreview(preview),
+	fData(blob->Data()),
+	fLength(blob->Size()),
+	fTitle(title),
+	fOrigin(origin),
+	fTimeAdded(added),
+	fTimeSince(since),
+	fId(0),
+	fSerial(0),
+	fHash(hash),
+	fBlob(true),
+	fPasted(false)
+{
+}
+
+
+const char*
+ClipRecord::GetPreviewData() const
+{
+	return fBlob ? fPreview.data() : fData;
+}
+
+
+size_t
+ClipRecord::GetPreviewLength() const
+{
+	if (fBlob)
+		return fPreview.length();
+
+	return preview_length(fData, fLength);
+}
+
+
+bool
+ClipRecord::ClipEquals(const char* clip, size_t length) const
+{
+	return length == fLength && memcmp(clip, fData, length) == 0;
+}
+
+
+void
+ClipRecord::SetTitle(const std::string& title)
+{
+	if (ClipEquals(title.data(), title.length()))
+		fTitle.clear();
+	else
+		fTitle = title;
+}
+
+
+// #pragma mark - ClipStore
+
+
+ClipStore::ClipStore(int32 limit)
+	:
+	fListener(NULL),
+	fBlobs(NULL),
+	fIndexing(true),
+	fLimit(limit),
+	fByteLimit(0),
+	fBytes(0),
+	fNextId(0),
+	fNextSerial(1),
+	fGeneration(0)
+{
+}
+
+
+ClipStore::~ClipStore()
+{
+	// The blobs stay for the next session
+	for (std::deque<ClipRecord*>::iterator it = fClips.begin();
+			it != fClips.end(); it++)
+		delete *it;
+}
+
+
+ClipRecord*
+ClipStore::ClipAt(int32 index) const
+{
+	if (index < 0 || index >= CountClips())
+		return NULL;
+
+	return fClips[index];
+}
+
+
+int32
+ClipStore::IndexOf(const ClipRecord* record) const
+{
+	if (record == NULL)
+		return -1;
+
+	// fClips is sorted by descending serial, so we can do a binary search
+	int32 low = 0;
+	int32 high = CountClips() - 1;
+	while (low <= high) {
+		int32 middle = low + (high - low) / 2;
+		uint64 serial = fClips[middle]->fSerial;
+		if (serial == record->fSerial)
+			return fClips[middle] == record ? middle : -1;
+		if (serial > record->fSerial)
+			low = middle + 1;
+		else
+			high = middle - 1;
+	}
+	return -1;
+}
+
+
+ClipRecord*
+ClipStore::FindClip(const ClipBuffer& clip) const
+{
+	return _FindClip(clip.Data(), clip.Length(), clip.Hash());
+}
+
+
+ClipRecord*
+ClipStore::FindClip(const std::string& clip) const
+{
+	return _FindClip(clip.data(), clip.length(),
+		hash_clip(clip.data(), clip.length()));
+}
+
+
+ClipRecord*
+ClipStore::FindHash(uint64 hash) const
+{
+	HashIndex::const_iterator found = fHashIndex.find(hash);
+	return found != fHashIndex.end() ? found->second : NULL;
+}
+
+
+int32
+ClipStore::AddClip(const ClipBufferRef& clip, const std::string& title,
+	const std::string& origin, bigtime_t added, bigtime_t since,
+	std::vector<int32>* removed)
+{
+	_MapBlobs();
+
+	if (fBlobs != NULL && fBlobs->ShouldStore(clip->Length())
+		&& fBlobs->Store(clip->Hash(), clip->Data(), clip->Length()) == B_OK) {
+		size_t previewLength = preview_length(clip->Data(), clip->Length());
+		INSTRUMENT_COPY(previewLength);
+		std::string preview(clip->Data(), previewLength);
+
+		std::shared_ptr<MappedFile> blob = fBlobs->Map(clip->Hash());
+		if (blob && blob->Size() == clip->Length()) {
+			ClipRecord* record = new ClipRecord(blob, clip->Hash(), preview,
+				std::string(), origin, added, since);
+			record->SetTitle(title);
+			return AddRecord(record, removed);
+		}
+
+		// It's still being written, until then the buffer is used
+		ClipRecord* record = new ClipRecord(clip, title, origin, added,
+			since);
+		record->fPreview.swap(preview);
+		record->fBlob = true;
+		fUnmappedBlobs.push_back(record->fHash);
+		return AddRecord(record, removed);
+	}
+	// Otherwise it's kept in memory
+
+	return AddRecord(new ClipRecord(clip, title, origin, added, since),
+		removed);
+}
+
+
+int32
+ClipStore::AddClip(const std::string& clip, const std::string& title,
+	const std::string& origin, bigtime_t added, bigtime_t since,
+	std::vector<int32>* removed)
+{
+	return AddClip(ClipBuffer::Create(clip.data(), clip.length()), title,
+		origin, added, since, removed);
+}
+
+
+int32
+ClipStore::SetByteLimit(uint64 limit, std::vector<int32>* removed)
+{
+	fByteLimit = limit;
+	return _Evict(0, 1, removed);
+}
+
+
+int32
+ClipStore::AddRecord(ClipRecord* record, std::vector<int32>* removed)
+{
+	int32 dropped = 0;
+	while (!fClips.empty() && CountClips() > fLimit - 1) {
+		if (removed != NULL)
+			removed->push_back(CountClips() - 1);
+		_RemoveAt(CountClips() - 1);
+		dropped++;
+	}
+	dropped += _Evict(record->fLength, 0, removed);
+	_Insert(record);
+
+	if (fListener != NULL)
+		fListener->ClipAdded(record);
+
+	return dropped;
+}
+
+
+void
+ClipStore::MergeOlder(ClipStore& older, std::vector<int32>* removed)
+{
+	TRACE_SPAN("ClipStore::MergeOlder");
+
+	// Take over the older clips, and put ours back on top of them
+	std::vector<ClipRecord*> newer(fClips.begin(), fClips.end());
+	fClips.swap(older.fClips);
+	fHashIndex.swap(older.fHashIndex);
+	fById.swap(older.fById);
+	fIndex.Swap(older.fIndex);
+	std::swap(fIndexing, older.fIndexing);
+	fBytes = older.fBytes;
+	fNextId = older.fNextId;
+	fNextSerial = older.fNextSerial;
+	fGeneration++;
+
+	older.fClips.clear();
+	older.fHashIndex.clear();
+	older.fById.clear();
+	older.fIndex.MakeEmpty();
+	older.fBytes = 0;
+
+	// Our clips are known to the listener already. An older copy of one
+	// shares its blob, which has to stay.
+	ClipStoreListener* listener = fListener;
+	BlobStore* blobs = fBlobs;
+	fListener = NULL;
+	for (size_t i = newer.size(); i-- > 0;) {
+		fBlobs = NULL;
+		ClipRecord* record = newer[i];
+		ClipRecord* duplicate = _FindClip(record->fData, record->fLength,
+			record->fHash);
+		if (duplicate != NULL)
+			_RemoveAt(IndexOf(duplicate));
+		fBlobs = blobs;
+		_Insert(record);
+	}
+	fListener = listener;
+
+	while (CountClips() > std::max(fLimit, 1)) {
+		if (removed != NULL)
+			removed->push_back(CountClips() - 1);
+		_RemoveAt(CountClips() - 1);
+	}
+	_Evict(0, 1, removed);
+}
+
+
+void
+ClipStore::MakeUnique(const ClipBuffer& clip, std::vector<int32>* removed)
+{
+	_MakeUnique(FindClip(clip), removed);
+}
+
+
+void
+ClipStore::MakeUnique(const std::string& clip, std::vector<int32>* removed)
+{
+	_MakeUnique(FindClip(clip), removed);
+}
+
+
+bool
+ClipStore::RemoveClip(int32 index)
+{
+	if (index < 0 || index >= CountClips())
+		return false;
+
+	_RemoveAt(index);
+	return true;
+}
+
+
+void
+ClipStore::MoveToTop(int32 index, bigtime_t added)
+{
+	if (index < 0 || index >= CountClips())
+		return;
+
+	ClipRecord* record = fClips[index];
+	fClips.erase(fClips.begin() + index);
+	record->fSerial = fNextSerial++;
+	record->fTimeAdded = added;
+	record->fPasted = true;
+	fClips.push_front(record);
+	fGeneration++;
+
+	if (fListener != NULL)
+		fListener->ClipMoved(record);
+}
+
+
+void
+ClipStore::SetTitle(ClipRecord* record, const std::string& title)
+{
+	if (record == NULL)
+		return;
+
+	record->SetTitle(title);
+	if (fListener != NULL)
+		fListener->ClipRetitled(record);
+}
+
+
+int32
+ClipStore::Crop(int32 limit)
+{
+	if (limit < 1)
+		limit = 1;
+
+	int32 removed = 0;
+	while (CountClips() > limit) {
+		_RemoveAt(CountClips() - 1);
+		removed++;
+	}
+	return removed;
+}
+
+
+void
+ClipStore::MakeEmpty()
+{
+	for (std::deque<ClipRecord*>::iterator it = fClips.begin();
+			it != fClips.end(); it++) {
+		if ((*it)->fBlob && fBlobs != NULL)
+			fBlobs->Remove((*it)->fHash);
+		delete *it;
+	}
+
+	fClips.clear();
+	fHashIndex.clear();
+	fById.clear();
+	fIndex.MakeEmpty();
+	fUnmappedBlobs.clear();
+	fBytes = 0;
+	fNextId = 0;
+	fGeneration++;
+
+	if (fListener != NULL)
+		fListener->StoreEmptied();
+}
+
+
+void
+ClipStore::PruneBlobs()
+{
+	if (fBlobs == NULL)
+		return;
+
+	std::unordered_set<uint64> keep;
+	for (size_t i = 0; i < fClips.size(); i++) {
+		if (fClips[i]->fBlob)
+			keep.insert(fClips[i]->fHash);
+	}
+	fBlobs->RemoveAllExcept(keep);
+}
+
+
+bool
+ClipStore::FindCandidates(const char* query, std::vector<int32>& indexes) const
+{
+	indexes.clear();
+
+	std::vector<uint32> ids;
+	if (!fIndexing || !fIndex.Find(query, ids))
+		return false;
+
+	for (size_t i = 0; i < ids.size(); i++) {
+		std::unordered_map<uint32, ClipRecord*>::const_iterator found
+			= fById.find(ids[i]);
+		if (found != fById.end())
+			indexes.push_back(IndexOf(found->second));
+	}
+	std::sort(indexes.begin(), indexes.end());
+	return true;
+}
+
+
+void
+ClipStore::SuspendIndex()
+{
+	fIndexing = false;
+	fIndex.MakeEmpty();
+}
+
+
+status_t
+ClipStore::LoadIndex(const char* path)
+{
+	TRACE_SPAN("ClipStore::LoadIndex");
+
+	// Saved ids count from the oldest clip, see SaveIndex()
+	int32 count = CountClips();
+	std::vector<uint32> loadIds(count);
+	for (int32 i = 0; i < count; i++)
+		loadIds[i] = fClips[count - 1 - i]->fId;
+
+	status_t status = fIndex.Load(path, _Signature(), loadIds);
+	if (status != B_OK) {
+		// Rebuild it, the ids have to be added in ascending order
+		std::vector<ClipRecord*> records(fClips.begin(), fClips.end());
+		std::sort(records.begin(), records.end(),
+			[](const ClipRecord* a, const ClipRecord* b) {
+				return a->fId < b->fId;
+			});
+
+		fIndex.MakeEmpty();
+		for (size_t i = 0; i < records.size(); i++)
+			fIndex.Add(records[i]->fId, records[i]->fData,
+				records[i]->fLength);
+	}
+	fIndexing = true;
+	return status;
+}
+
+
+status_t
+ClipStore::SaveIndex(const char* path) const
+{
+	std::string buffer;
+	status_t status = SnapshotIndex(buffer);
+	if (status != B_OK)
+		return status;
+	return write_file_atomically(path, buffer.data(), buffer.length());
+}
+
+
+status_t
+ClipStore::SnapshotIndex(std::string& buffer) const
+{
+	if (!fIndexing)
+		return B_ERROR;
+
+	// The history is loaded oldest first, so that's how the ids get
+	// handed out again.
+	int32 count = CountClips();
+	std::unordered_map<uint32, uint32> saveIds;
+	for (int32 i = 0; i < count; i++)
+		saveIds[fClips[i]->fId] = count - 1 - i;
+
+	fIndex.Snapshot(buffer, _Signature(), saveIds);
+	return B_OK;
+}
+
+
+void
+ClipStore::_RemoveAt(int32 index)
+{
+	ClipRecord* record = fClips[index];
+	if (fListener != NULL)
+		fListener->ClipRemoved(record);
+
+	std::pair<HashIndex::iterator, HashIndex::iterator> range
+		= fHashIndex.equal_range(record->fHash);
+	for (HashIndex::iterator it = range.first; it != range.second; it++) {
+		if (it->second == record) {
+			fHashIndex.erase(it);
+			break;
+		}
+	}
+
+	fById.erase(record->fId);
+	fIndex.Remove(record->fId);
+	fBytes -= record->fLength;
+
+	if (record->fBlob && fBlobs != NULL)
+		fBlobs->Remove(record->fHash);
+	delete record;
+	fClips.erase(fClips.begin() + index);
+	fGeneration++;
+}
+
+
+void
+ClipStore::_Insert(ClipRecord* record)
+{
+	record->fId = fNextId++;
+	record->fSerial = fNextSerial++;
+	fClips.push_front(record);
+	fHashIndex.insert(HashIndex::value_type(record->fHash, record));
+	fById[record->fId] = record;
+	fBytes += record->fLength;
+	if (fIndexing)
+		fIndex.Add(record->fId, record->fData, record->fLength);
+	fGeneration++;
+}
+
+
+int32
+ClipStore::_Evict(uint64 incoming, int32 keep, std::vector<int32>* removed)
+{
+	if (fByteLimit == 0)
+		return 0;
+
+	int32 evicted = 0;
+	while (CountClips() > keep && fBytes + incoming > fByteLimit) {
+		int32 index = _PickVictim(keep);
+		if (removed != NULL)
+			removed->push_back(index);
+		_RemoveAt(index);
+		evicted++;
+	}
+	return evicted;
+}
+
+
+int32
+ClipStore::_PickVictim(int32 first) const
+{
+	int32 count = CountClips();
+	int32 victim = count - 1;
+	uint64 victimScore = 0;
+	for (int32 i = count - 1; i >= std::max(first, count - kEvictionWindow);
+			i--) {
+		const ClipRecord* record = fClips[i];
+		// Larger and older (further down) means more to gain, and less to
+		// lose. Pasting a clip shows it's worth keeping.
+		uint64 score = (record->fLength + kRecordOverhead) * (i + 1);
+		if (record->fPasted)
+			score /= 4;
+		if (score > victimScore) {
+			victim = i;
+			victimScore = score;
+		}
+	}
+	return victim;
+}
+
+
+void
+ClipStore::_MapBlobs()
+{
+	// Once a blob is written, its clip lets go of the buffer
+	for (size_t i = 0; i < fUnmappedBlobs.size();) {
+		ClipRecord* record = FindHash(fUnmappedBlobs[i]);
+		if (record != NULL && record->fBlob && record->fBuffer
+			&& fBlobs != NULL) {
+			std::shared_ptr<MappedFile> blob = fBlobs->Map(record->fHash);
+			if (!blob || blob->Size() != record->fLength) {
+				i++;
+				continue;
+			}
+			record->fMapping = blob;
+			record->fData = blob->Data();
+			record->fBuffer.reset();
+		}
+		fUnmappedBlobs.erase(fUnmappedBlobs.begin() + i);
+	}
+}
+
+
+ClipRecord*
+ClipStore::_FindClip(const char* clip, size_t length, uint64 hash) const
+{
+	std::pair<HashIndex::const_iterator, HashIndex::const_iterator> range
+		= fHashIndex.equal_range(hash);
+	for (HashIndex::const_iterator it = range.first; it != range.second; it++) {
+		if (it->second->ClipEquals(clip, length))
+			return it->second;
+	}
+	return NULL;
+}
+
+
+void
+ClipStore::_MakeUnique(ClipRecord* record, std::vector<int32>* removed)
+{
+	// The store never holds duplicates, so there's at most one
+	int32 index = IndexOf(record);
+	if (index < 0)
+		return;
+
+	_RemoveAt(index);
+	if (removed != NULL)
+		removed->push_back(index);
+}
+
+
+uint64
+ClipStore::_Signature() const
+{
+	std::vector<uint64> hashes;
+	hashes.reserve(fClips.size());
+	for (size_t i = 0; i < fClips.size(); i++)
+		hashes.push_back(fClips[i]->fHash);
+
+	return hash_clip(hashes.data(), hashes.size() * sizeof(uint64));
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * The clip history model. It doesn't use the Be API, so it can be built
+ * and profiled headless (see headless/makefile). MainWindow drives it and
+ * the ClipView shows it.
+ */
+
+#ifndef CLIPSTORE_H
+#define CLIPSTORE_H
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BlobStore.h"
+#include "ClipBuffer.h"
+#include "CoreDefs.h"
+#include "MappedFile.h"
+#include "TrigramIndex.h"
+
+
+// At most this much of a clip is needed to display it
+static const size_t kPreviewLength = 1024;
+
+
+class ClipRecord {
+public:
+						// Shares the buffer
+						ClipRecord(const ClipBufferRef& clip,
+							const std::string& title, const std::string& origin,
+							bigtime_t added, bigtime_t since);
+						// A clip that stays in the mapped file
+						ClipRecord(const std::shared_ptr<MappedFile>& mapping,
+							const char* clip, size_t length, uint64 hash,
+							const std::string& title, const std::string& origin,
+							bigtime_t added, bigtime_t since);
+						// A clip kept in a blob, see BlobStore
+						ClipRecord(const std::shared_ptr<MappedFile>& blob,
+							uint64 hash, const std::string& preview,
+							const std::string& title, const std::string& origin,
+							bigtime_t added, bigtime_t since);
+
+	// The clip's bytes, they may only get paged in on access
+	const char*			GetClipData() const { return fData; }
+	size_t				GetClipLength() const { return fLength; }
+	// The start of the clip, without touching a blob's contents. It isn't
+	// cut in the middle of a UTF-8 character.
+	const char*			GetPreviewData() const;
+	size_t				GetPreviewLength() const;
+	bool				IsBlob() const { return fBlob; }
+	bool				ClipEquals(const char* clip, size_t length) const;
+	const std::string&	GetOrigin() const { return fOrigin; }
+
+	// The user title, empty if there's none
+	const std::string&	GetTitle() const { return fTitle; }
+	bool				HasTitle() const { return !fTitle.empty(); }
+	void				SetTitle(const std::string& title);
+
+	bigtime_t			GetTimeAdded() const { return fTimeAdded; }
+	void				SetTimeAdded(bigtime_t added) { fTimeAdded = added; }
+	bigtime_t			GetTimeSince() const { return fTimeSince; }
+	void				SetTimeSince(bigtime_t since) { fTimeSince = since; }
+
+	// Pasted clips are the last to be evicted
+	bool				WasPasted() const { return fPasted; }
+	void				SetPasted(bool pasted) { fPasted = pasted; }
+
+	// hash_clip() of the clip, it identifies the clip across sessions
+	uint64				GetHash() const { return fHash; }
+	// Unique within the store, new clips get new ids. MergeOlder() and
+	// MakeEmpty() start over.
+	uint32				GetId() const { return fId; }
+
+private:
+	friend class ClipStore;
+
+						ClipRecord(const ClipRecord&);
+			ClipRecord&	operator=(const ClipRecord&);
+
+	ClipBufferRef		fBuffer;		// The actual clip, unless mapped
+	std::shared_ptr<MappedFile> fMapping;	// Of the journal or the blob
+	std::string			fPreview;		// Only for blobs
+	const char*			fData;			// The clip's bytes, never touch!
+	size_t				fLength;
+	std::string			fTitle;			// The optional user title.
+	std::string			fOrigin;
+	bigtime_t			fTimeAdded;
+	bigtime_t			fTimeSince;
+	uint32				fId;			// Unique within the store
+	uint64				fSerial;		// Ordering key, newest is highest
+	uint64				fHash;			// hash_clip() of the clip
+	bool				fBlob;
+	bool				fPasted;
+};
+
+
+// Gets told about every change of the store, e.g. to persist it
+class ClipStoreListener {
+public:
+	virtual				~ClipStoreListener() {}
+
+	virtual	void		ClipAdded(const ClipRecord* record) = 0;
+	// Called before the record is deleted
+	virtual	void		ClipRemoved(const ClipRecord* record) = 0;
+	virtual	void		ClipMoved(const ClipRecord* record) = 0;
+	virtual	void		ClipRetitled(const ClipRecord* record) = 0;
+	virtual	void		StoreEmptied() = 0;
+};
+
+
+class ClipStore {
+public:
+						ClipStore(int32 limit);
+						~ClipStore();
+
+	int32				CountClips() const { return fClips.size(); }
+	bool				IsEmpty() const { return fClips.empty(); }
+	ClipRecord*			ClipAt(int32 index) const;
+	int32				IndexOf(const ClipRecord* record) const;
+	// The clip with exactly these contents, or NULL
+	ClipRecord*			FindClip(const ClipBuffer& clip) const;
+	ClipRecord*			FindClip(const std::string& clip) const;
+	ClipRecord*			FindHash(uint64 hash) const;
+
+	void				SetListener(ClipStoreListener* listener)
+							{ fListener = listener; }
+
+	// Large clips that are added are moved to the blob store. Blobs of
+	// removed clips get deleted.
+	void				SetBlobStore(BlobStore* blobs) { fBlobs = blobs; }
+	BlobStore*			GetBlobStore() const { return fBlobs; }
+	// Deletes the blobs that don't belong to any clip
+	void				PruneBlobs();
+
+	// Changes whenever clips are added, removed or reordered
+	uint32				Generation() const { return fGeneration; }
+
+	int32				Limit() const { return fLimit; }
+	void				SetLimit(int32 limit) { fLimit = limit; }
+
+	// Optional budget for the size of all clips, 0 if there's none. Going
+	// over it evicts clips, preferably large, old ones that were never
+	// pasted. The newest clip is kept even if it's over budget on its own.
+	uint64				ByteLimit() const { return fByteLimit; }
+	int32				SetByteLimit(uint64 limit,
+							std::vector<int32>* removed = NULL);
+	uint64				CountBytes() const { return fBytes; }
+
+	// Adds a new clip at the top. Returns the number of clips that were
+	// dropped to stay within the limits. The indexes of the dropped clips
+	// are returned in the order they were removed, so they can be removed
+	// from a mirroring list one by one.
+	int32				AddClip(const ClipBufferRef& clip,
+							const std::string& title, const std::string& origin,
+							bigtime_t added, bigtime_t since,
+							std::vector<int32>* removed = NULL);
+	// Copies the clip into a new buffer
+	int32				AddClip(const std::string& clip,
+							const std::string& title, const std::string& origin,
+							bigtime_t added, bigtime_t since,
+							std::vector<int32>* removed = NULL);
+	// Like AddClip(), but takes over an already created record
+	int32				AddRecord(ClipRecord* record,
+							std::vector<int32>* removed = NULL);
+	// Takes over all clips of 'older', e.g. a history that was loaded in
+	// the background, and puts the own clips back on top of them, older
+	// copies of them are dropped. The listener is only told about clips
+	// that are dropped to stay within the limits afterwards, their indexes
+	// are returned like with AddClip(). 'older' is left empty.
+	void				MergeOlder(ClipStore& older,
+							std::vector<int32>* removed = NULL);
+	// Removes all clips with the same contents. The indexes of the removed
+	// clips are returned in descending order, so they can be removed from
+	// a mirroring list one by one.
+	void				MakeUnique(const ClipBuffer& clip,
+							std::vector<int32>* removed = NULL);
+	void				MakeUnique(const std::string& clip,
+							std::vector<int32>* removed = NULL);
+	bool				RemoveClip(int32 index);
+	void				MoveToTop(int32 index, bigtime_t added);
+	void				SetTitle(ClipRecord* record, const std::string& title);
+	// Keeps at most 'limit' (but at least one) clips. Returns the number
+	// of removed clips.
+	int32				Crop(int32 limit);
+	void				MakeEmpty();
+
+	// Store indexes of the clips that may contain 'query', in ascending
+	// order. They still have to be verified. Returns false if the trigram
+	// index can't narrow down the search and all clips have to be checked.
+	bool				FindCandidates(const char* query,
+							std::vector<int32>& indexes) const;
+
+	// Stops maintaining the trigram index, e.g. while loading the history.
+	// LoadIndex() reads it back from a file saved with SaveIndex() if that
+	// still matches the clips, or rebuilds it, and resumes indexing.
+	void				SuspendIndex();
+	status_t			LoadIndex(const char* path);
+	status_t			SaveIndex(const char* path) const;
+	// What SaveIndex() writes, e.g. to hand it to a FileWriter
+	status_t			SnapshotIndex(std::string& buffer) const;
+
+private:
+	typedef std::unordered_multimap<uint64, ClipRecord*> HashIndex;
+
+	void				_Insert(ClipRecord* record);
+	void				_RemoveAt(int32 index);
+	int32				_Evict(uint64 incoming, int32 keep,
+							std::vector<int32>* removed);
+	int32				_PickVictim(int32 first) const;
+	void				_MapBlobs();
+	ClipRecord*			_FindClip(const char* clip, size_t length,
+							uint64 hash) const;
+	void				_MakeUnique(ClipRecord* record,
+							std::vector<int32>* removed);
+	uint64				_Signature() const;
+
+	std::deque<ClipRecord*>	fClips;		// Newest first, by descending serial
+	HashIndex			fHashIndex;
+	std::unordered_map<uint32, ClipRecord*> fById;
+	TrigramIndex		fIndex;
+	// Hashes of blobs that were still being written when they were added
+	std::vector<uint64>	fUnmappedBlobs;
+	ClipStoreListener*	fListener;
+	BlobStore*			fBlobs;
+	bool				fIndexing;
+	int32				fLimit;
+	uint64				fByteLimit;
+	uint64				fBytes;
+	uint32				fNextId;
+	uint64				fNextSerial;
+	uint32				fGeneration;
+};
+
+#endif // CLIPSTORE_H
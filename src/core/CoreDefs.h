@@ -0,0 +1,45 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Basic types for the headless history engine. On Haiku these come from
+ * the system headers, elsewhere (e.g. the Linux harness) we provide
+ * compatible definitions, so the engine doesn't depend on the Be API.
+ */
+
+#ifndef CORE_DEFS_H
+#define CORE_DEFS_H
+
+#ifdef __HAIKU__
+
+#include <Errors.h>
+#include <SupportDefs.h>
+
+#else
+
+#include <stdint.h>
+
+typedef int8_t		int8;
+typedef uint8_t		uint8;
+typedef int16_t		int16;
+typedef uint16_t	uint16;
+typedef int32_t		int32;
+typedef uint32_t	uint32;
+typedef int64_t		int64;
+typedef uint64_t	uint64;
+
+typedef int32		status_t;
+typedef int64		bigtime_t;
+
+#define B_OK					((status_t)0)
+#define B_ERROR					((status_t)-1)
+#define B_NO_MEMORY				((status_t)(INT32_MIN + 0))
+#define B_IO_ERROR				((status_t)(INT32_MIN + 1))
+#define B_BAD_VALUE				((status_t)(INT32_MIN + 5))
+#define B_NO_INIT				((status_t)(INT32_MIN + 13))
+#define B_BAD_DATA				((status_t)(INT32_MIN + 16))
+#define B_ENTRY_NOT_FOUND		((status_t)(INT32_MIN + 0x6003))
+
+#endif // __HAIKU__
+
+#endif // CORE_DEFS_H
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include "FadeSchedule.h"
+
+
+FadeSchedule::FadeSchedule()
+	:
+	fInterval(0),
+	fSteps(0)
+{
+}
+
+
+void
+FadeSchedule::SetTo(bigtime_t interval, int32 steps)
+{
+	fInterval = interval;
+	fSteps = (interval > 0 && steps > 0) ? steps : 0;
+}
+
+
+int32
+FadeSchedule::LevelAt(bigtime_t since, bigtime_t now) const
+{
+	if (fSteps == 0 || now <= since)
+		return 0;
+
+	bigtime_t level = (now - since) / fInterval;
+	return level < fSteps ? (int32)level : fSteps;
+}
+
+
+bigtime_t
+FadeSchedule::NextChange(bigtime_t since, bigtime_t now) const
+{
+	int32 level = LevelAt(since, now);
+	if (level == fSteps)
+		return 0;
+	return since + (level + 1) * fInterval;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * When history items fade: a level every interval after they were added,
+ * up to a number of steps. Colors are left to the view, which only needs
+ * one per level.
+ */
+
+#ifndef FADESCHEDULE_H
+#define FADESCHEDULE_H
+
+#include "CoreDefs.h"
+
+
+class FadeSchedule {
+public:
+						FadeSchedule();
+
+	// 'interval' in seconds. No fading with 0 steps.
+	void				SetTo(bigtime_t interval, int32 steps);
+	int32				CountSteps() const { return fSteps; }
+
+	// Level of an item added at 'since', from 0 to CountSteps()
+	int32				LevelAt(bigtime_t since, bigtime_t now) const;
+	// When that item reaches its next level, 0 if it's done fading
+	bigtime_t			NextChange(bigtime_t since, bigtime_t now) const;
+
+private:
+	bigtime_t			fInterval;
+	int32				fSteps;
+};
+
+#endif // FADESCHEDULE_H
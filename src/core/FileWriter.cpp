@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <string.h>
+
+#include "FileWriter.h"
+#include "RecordFile.h"
+#include "Tracing.h"
+
+
+bigtime_t
+monotonic_time()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+FileWriter::FileWriter(bigtime_t delay)
+	:
+	fDelay(delay),
+	fSequence(0),
+	fFlushing(0),
+	fWriting(false),
+	fQuitting(false)
+{
+	memset(&fStats, 0, sizeof(fStats));
+	fThread = std::thread(&FileWriter::_Run, this);
+}
+
+
+FileWriter::~FileWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(fLock);
+		fQuitting = true;
+	}
+	fCondition.notify_all();
+	fThread.join();
+}
+
+
+void
+FileWriter::SetDelay(bigtime_t delay)
+{
+	std::lock_guard<std::mutex> lock(fLock);
+	fDelay = delay;
+	fCondition.notify_all();
+}
+
+
+void
+FileWriter::Replace(const std::string& path, std::string data)
+{
+	std::lock_guard<std::mutex> lock(fLock);
+	fStats.requests++;
+
+	JobMap::iterator found = fJobs.find(path);
+	if (found != fJobs.end()) {
+		found->second.replace = true;
+		found->second.data.swap(data);
+		found->second.sequence = fSequence++;
+		fStats.skipped++;
+		return;
+	}
+
+	Job& job = fJobs[path];
+	job.replace = true;
+	job.data.swap(data);
+	job.requested = monotonic_time();
+	job.sequence = fSequence++;
+	fCondition.notify_all();
+}
+
+
+void
+FileWriter::Append(const std::string& path, const std::string& data)
+{
+	std::lock_guard<std::mutex> lock(fLock);
+	fStats.requests++;
+
+	JobMap::iterator found = fJobs.find(path);
+	if (found != fJobs.end()) {
+		found->second.data += data;
+		found->second.sequence = fSequence++;
+		fStats.skipped++;
+		return;
+	}
+
+	Job& job = fJobs[path];
+	job.replace = false;
+	job.data = data;
+	job.requested = monotonic_time();
+	job.sequence = fSequence++;
+	fCondition.notify_all();
+}
+
+
+void
+FileWriter::Flush()
+{
+	std::unique_lock<std::mutex> lock(fLock);
+	fFlushing++;
+	fCondition.notify_all();
+	while (!fJobs.empty() || fWriting)
+		fWritten.wait(lock);
+	fFlushing--;
+}
+
+
+void
+FileWriter::GetStats(writer_stats& stats)
+{
+	std::lock_guard<std::mutex> lock(fLock);
+	stats = fStats;
+}
+
+
+void
+FileWriter::_Run()
+{
+	TRACE_THREAD("file writer");
+
+	std::unique_lock<std::mutex> lock(fLock);
+	while (true) {
+		if (fJobs.empty()) {
+			if (fQuitting)
+				break;
+			fCondition.wait(lock);
+			continue;
+		}
+
+		// Give more requests the chance to come in, unless someone waits
+		bigtime_t oldest = fJobs.begin()->second.requested;
+		for (JobMap::iterator it = fJobs.begin(); it != fJobs.end(); it++)
+			oldest = std::min(oldest, it->second.requested);
+		bigtime_t wait = oldest + fDelay - monotonic_time();
+		if (wait > 0 && fFlushing == 0 && !fQuitting) {
+			fCondition.wait_for(lock, std::chrono::microseconds(wait));
+			continue;
+		}
+
+		JobMap jobs;
+		jobs.swap(fJobs);
+		fWriting = true;
+		lock.unlock();
+
+		// In the order they were last requested in
+		std::vector<JobMap::iterator> order;
+		for (JobMap::iterator it = jobs.begin(); it != jobs.end(); it++)
+			order.push_back(it);
+		std::sort(order.begin(), order.end(),
+			[](JobMap::iterator a, JobMap::iterator b) {
+				return a->second.sequence < b->second.sequence;
+			});
+
+		int64 failed = 0;
+		for (size_t i = 0; i < order.size(); i++) {
+			if (_Write(order[i]->first, order[i]->second) != B_OK)
+				failed++;
+		}
+		bigtime_t done = monotonic_time();
+
+		lock.lock();
+		for (JobMap::iterator it = jobs.begin(); it != jobs.end(); it++) {
+			bigtime_t latency = done - it->second.requested;
+			fStats.writes++;
+			fStats.last_latency = latency;
+			fStats.max_latency = std::max(fStats.max_latency, latency);
+			fStats.total_latency += latency;
+		}
+		fStats.failed += failed;
+		fWriting = false;
+		fWritten.notify_all();
+	}
+}
+
+
+/*static*/ status_t
+FileWriter::_Write(const std::string& path, const Job& job)
+{
+	TRACE_SPAN("FileWriter::_Write");
+
+	if (job.replace) {
+		return write_file_atomically(path.c_str(), job.data.data(),
+			job.data.length());
+	}
+	return append_to_file(path.c_str(), job.data.data(), job.data.length());
+}
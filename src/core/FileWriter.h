@@ -0,0 +1,81 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Writes files in a background thread. Callers hand over the data to
+ * write and go on right away. Requests for the same file that come in
+ * within the delay are coalesced into a single write. Files are written in
+ * the order they were last requested in, so a file that another one
+ * refers to, like a blob in the journal, is requested first.
+ */
+
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "CoreDefs.h"
+
+
+struct writer_stats {
+	int64		requests;
+	int64		writes;
+	int64		skipped;		// Requests that were coalesced
+	int64		failed;
+	bigtime_t	last_latency;	// From the first request to the write
+	bigtime_t	max_latency;
+	bigtime_t	total_latency;
+};
+
+
+class FileWriter {
+public:
+						FileWriter(bigtime_t delay = 0);
+						~FileWriter();
+
+	void				SetDelay(bigtime_t delay);
+
+	// Replaces the file's contents. Pending appends are dropped, the new
+	// contents are expected to include them.
+	void				Replace(const std::string& path, std::string data);
+	void				Append(const std::string& path,
+							const std::string& data);
+
+	// Waits until everything requested so far has been written
+	void				Flush();
+
+	void				GetStats(writer_stats& stats);
+
+private:
+	struct Job {
+		bool		replace;
+		std::string	data;
+		bigtime_t	requested;
+		uint64		sequence;	// Of the last request
+	};
+	typedef std::map<std::string, Job> JobMap;
+
+	void				_Run();
+	static status_t		_Write(const std::string& path, const Job& job);
+
+	std::mutex			fLock;
+	std::condition_variable fCondition;
+	std::condition_variable fWritten;
+	JobMap				fJobs;
+	bigtime_t			fDelay;
+	uint64				fSequence;
+	int32				fFlushing;
+	bool				fWriting;
+	bool				fQuitting;
+	writer_stats		fStats;
+	std::thread			fThread;
+};
+
+
+bigtime_t	monotonic_time();
+
+#endif // FILEWRITER_H
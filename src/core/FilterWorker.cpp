@@ -0,0 +1,282 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+
+#include "FileWriter.h"
+#include "FilterWorker.h"
+#include "FuzzyMatcher.h"
+#include "Tracing.h"
+
+
+// Clips ranked between looking for a cancel, fewer if they are large
+static const int32 kStepClips = 32;
+static const size_t kStepBytes = 256 * 1024;
+// Partial matches are handed out about once a frame
+static const bigtime_t kUpdateInterval = 16000;
+// How long the final matches wait for the target before checking whether
+// they are still wanted
+static const bigtime_t kNotifyTimeout = 100000;
+
+
+FilterWorker::FilterWorker(const ClipStore& store, int32 threads)
+	:
+	fStore(store),
+	fFilter(store),
+	fSearch(threads),
+	fGeneration(0),
+	fFuzzy(false),
+	fNow(0),
+	fCount(0),
+	fPending(false),
+	fBusy(false),
+	fQuitting(false),
+	fMatchesGeneration(0),
+	fDone(false),
+	fNotified(false)
+{
+	fThread = std::thread(&FilterWorker::_Run, this);
+}
+
+
+FilterWorker::~FilterWorker()
+{
+	fGeneration++;
+	{
+		std::lock_guard<std::mutex> lock(fLock);
+		fQuitting = true;
+	}
+	fCondition.notify_all();
+	fThread.join();
+}
+
+
+void
+FilterWorker::SetFoundFunction(const FoundFunction& found)
+{
+	std::lock_guard<std::mutex> lock(fLock);
+	fFound = found;
+}
+
+
+uint32
+FilterWorker::Start(const char* query)
+{
+	return _Start(query, false, 0, 0);
+}
+
+
+uint32
+FilterWorker::StartFuzzy(const char* query, bigtime_t now, int32 count)
+{
+	return _Start(query, true, now, count);
+}
+
+
+void
+FilterWorker::Cancel()
+{
+	// The worker checks the generation between steps, and is done with
+	// the store once it notices
+	fGeneration++;
+	std::unique_lock<std::mutex> lock(fLock);
+	fPending = false;
+	while (fBusy)
+		fIdle.wait(lock);
+}
+
+
+void
+FilterWorker::Reset()
+{
+	Cancel();
+	std::lock_guard<std::mutex> lock(fLock);
+	fFilter.Reset();
+}
+
+
+bool
+FilterWorker::GetMatches(uint32 generation, std::vector<int32>& matches,
+	bool& done)
+{
+	std::lock_guard<std::mutex> lock(fMatchesLock);
+	fNotified = false;
+	if (generation != fGeneration || generation != fMatchesGeneration)
+		return false;
+
+	matches = fMatches;
+	done = fDone;
+	return true;
+}
+
+
+uint32
+FilterWorker::_Start(const char* query, bool fuzzy, bigtime_t now,
+	int32 count)
+{
+	Cancel();
+
+	std::lock_guard<std::mutex> lock(fLock);
+	{
+		std::lock_guard<std::mutex> matchesLock(fMatchesLock);
+		fMatches.clear();
+		fMatchesGeneration = 0;
+		fDone = false;
+		fNotified = false;
+	}
+
+	fQuery = query;
+	fFuzzy = fuzzy;
+	fNow = now;
+	fCount = count;
+	fPending = true;
+	fCondition.notify_all();
+	return fGeneration;
+}
+
+
+void
+FilterWorker::_Run()
+{
+	TRACE_THREAD("filter worker");
+
+	std::unique_lock<std::mutex> lock(fLock);
+	while (!fQuitting) {
+		if (!fPending) {
+			fCondition.wait(lock);
+			continue;
+		}
+
+		fPending = false;
+		fBusy = true;
+		uint32 generation = fGeneration;
+
+		// The query stays as it is until Cancel() saw fBusy cleared
+		lock.unlock();
+		if (fFuzzy)
+			_Rank(generation);
+		else
+			_Filter(generation);
+		lock.lock();
+		fBusy = false;
+		fIdle.notify_all();
+
+		// Done with the store, so the target may take its time: it can
+		// cancel meanwhile without waiting for us
+		lock.unlock();
+		while (!_Notify(generation, kNotifyTimeout)
+			&& generation == fGeneration) {
+		}
+		lock.lock();
+	}
+}
+
+
+void
+FilterWorker::_Filter(uint32 generation)
+{
+	TRACE_SPAN("FilterWorker::_Filter");
+
+	fFilter.Begin(fQuery.c_str());
+	bigtime_t published = monotonic_time();
+	bool done = fFilter.Finish(fSearch,
+		[this, generation]() {
+			return fGeneration != generation;
+		},
+		[&]() {
+			bigtime_t now = monotonic_time();
+			if (now - published >= kUpdateInterval) {
+				_Publish(generation, fFilter.Matches(), false);
+				published = now;
+			}
+		});
+	if (done)
+		_Publish(generation, fFilter.Matches(), true);
+}
+
+
+void
+FilterWorker::_Rank(uint32 generation)
+{
+	TRACE_SPAN("FilterWorker::_Rank");
+
+	// Like rank_clips(), the best ones so far are handed out
+	FuzzyMatcher matcher(fQuery.c_str());
+	TopResults top(fCount);
+	std::vector<FuzzyResult> results;
+	std::vector<int32> ranked;
+	bigtime_t published = monotonic_time();
+	int32 index = 0;
+	while (fGeneration == generation) {
+		int32 end = std::min(fStore.CountClips(), index + kStepClips);
+		size_t bytes = 0;
+		for (; index < end && bytes < kStepBytes; index++) {
+			const ClipRecord* record = fStore.ClipAt(index);
+			int32 score;
+			if (matcher.Score(record->GetClipData(),
+					record->GetClipLength(), &score)) {
+				top.Add(index, score
+					+ recency_bonus(fNow - record->GetTimeAdded()));
+			}
+			bytes += record->GetClipLength();
+		}
+
+		bool done = index >= fStore.CountClips();
+		bigtime_t now = monotonic_time();
+		if (done || now - published >= kUpdateInterval) {
+			top.GetResults(results);
+			ranked.clear();
+			for (size_t i = 0; i < results.size(); i++)
+				ranked.push_back(results[i].index);
+
+			_Publish(generation, ranked, done);
+			published = now;
+		}
+		if (done)
+			break;
+	}
+}
+
+
+void
+FilterWorker::_Publish(uint32 generation, const std::vector<int32>& matches,
+	bool done)
+{
+	{
+		std::lock_guard<std::mutex> matchesLock(fMatchesLock);
+		if (generation != fGeneration)
+			return;
+
+		fMatches = matches;
+		fMatchesGeneration = generation;
+		fDone = done;
+	}
+
+	// Cancel() may be waiting for us, so only if the target can take it
+	// right away. The final matches are announced by _Run().
+	if (!done)
+		_Notify(generation, 0);
+}
+
+
+bool
+FilterWorker::_Notify(uint32 generation, bigtime_t timeout)
+{
+	{
+		std::lock_guard<std::mutex> matchesLock(fMatchesLock);
+		if (generation != fGeneration || generation != fMatchesGeneration
+			|| fNotified || !fFound)
+			return true;
+		fNotified = true;
+	}
+
+	if (fFound(generation, timeout))
+		return true;
+
+	// The next publish tries again
+	std::lock_guard<std::mutex> matchesLock(fMatchesLock);
+	fNotified = false;
+	return false;
+}
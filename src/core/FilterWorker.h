@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Filters the history in a thread of its own, so a slow query over a long
+ * history doesn't hold up the window. Every query gets a new generation
+ * and cancels the one in flight. The substring filter spreads a long
+ * history over all cores (see ParallelSearch). The clips are checked a
+ * few at a time; the matches found so far are handed out with
+ * GetMatches() while the query goes on.
+ *
+ * The worker reads the store until the query is done or cancelled, so
+ * the store must not change meanwhile: call Cancel() before changing it.
+ */
+
+#ifndef FILTERWORKER_H
+#define FILTERWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ClipFilter.h"
+#include "ClipStore.h"
+
+
+class FilterWorker {
+public:
+	// Called from the worker thread when there are new matches for the
+	// query 'generation'. Not again until they were fetched. Returns
+	// false if it couldn't tell within 'timeout', it's asked again then.
+	// While the worker may still hold up Cancel(), 'timeout' is 0.
+	typedef std::function<bool(uint32 generation, bigtime_t timeout)>
+		FoundFunction;
+
+						// See ParallelSearch for 'threads'
+						FilterWorker(const ClipStore& store,
+							int32 threads = 0);
+						~FilterWorker();
+
+	// Has to be set before the first query
+	void				SetFoundFunction(const FoundFunction& found);
+
+	// Substring filter, see ClipFilter. Returns the query's generation.
+	uint32				Start(const char* query);
+	// Ranked, see rank_clips()
+	uint32				StartFuzzy(const char* query, bigtime_t now,
+							int32 count);
+	// Cancels the query in flight. Once this returns, the worker doesn't
+	// touch the store until the next query.
+	void				Cancel();
+	// Cancels, and forgets the results cached by the ClipFilter
+	void				Reset();
+
+	// The matches found so far, as store indexes. Returns false if
+	// 'generation' isn't the current query, or nothing was found yet.
+	// 'done' is set once all clips were checked.
+	bool				GetMatches(uint32 generation,
+							std::vector<int32>& matches, bool& done);
+
+private:
+	uint32				_Start(const char* query, bool fuzzy,
+							bigtime_t now, int32 count);
+	void				_Run();
+	void				_Filter(uint32 generation);
+	void				_Rank(uint32 generation);
+	void				_Publish(uint32 generation,
+							const std::vector<int32>& matches, bool done);
+	bool				_Notify(uint32 generation, bigtime_t timeout);
+
+	const ClipStore&	fStore;
+	ClipFilter			fFilter;
+	ParallelSearch		fSearch;
+	FoundFunction		fFound;
+	std::atomic<uint32>	fGeneration;
+
+	std::mutex			fLock;
+	std::condition_variable fCondition;
+	std::condition_variable fIdle;
+	std::string			fQuery;
+	bool				fFuzzy;
+	bigtime_t			fNow;
+	int32				fCount;
+	bool				fPending;
+	bool				fBusy;			// with the store
+	bool				fQuitting;
+
+	// What GetMatches() returns
+	std::mutex			fMatchesLock;
+	std::vector<int32>	fMatches;
+	uint32				fMatchesGeneration;
+	bool				fDone;
+	bool				fNotified;
+
+	std::thread			fThread;
+};
+
+#endif // FILTERWORKER_H
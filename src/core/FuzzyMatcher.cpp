@@ -0,0 +1,253 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+
+#include <string.h>
+
+#include "ClipStore.h"
+#include "FuzzyMatcher.h"
+#include "TextSearch.h"
+#include "Tracing.h"
+
+
+// Scoring as in fzf's FuzzyMatchV1
+static const int32 kScoreMatch = 16;
+static const int32 kScoreGapStart = -3;
+static const int32 kScoreGapExtension = -1;
+static const int32 kBonusBoundary = kScoreMatch / 2;
+static const int32 kBonusNonWord = kScoreMatch / 2;
+static const int32 kBonusCamel = kBonusBoundary + kScoreGapExtension;
+static const int32 kBonusConsecutive = -(kScoreGapStart + kScoreGapExtension);
+static const int32 kBonusFirstCharMultiplier = 2;
+
+static const int32 kRecencyBonus = 2 * kScoreMatch;
+
+enum char_class {
+	CHAR_WHITE,
+	CHAR_NON_WORD,
+	CHAR_LOWER,
+	CHAR_UPPER,
+	CHAR_LETTER,
+	CHAR_NUMBER
+};
+
+
+static inline char_class
+class_of(uint32 c)
+{
+	if (c < 0x80) {
+		if (c >= 'a' && c <= 'z')
+			return CHAR_LOWER;
+		if (c >= 'A' && c <= 'Z')
+			return CHAR_UPPER;
+		if (c >= '0' && c <= '9')
+			return CHAR_NUMBER;
+		if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+			return CHAR_WHITE;
+		return CHAR_NON_WORD;
+	}
+	if ((c & kInvalidByte) != 0)
+		return CHAR_NON_WORD;
+	if (fold_char(c) != c)
+		return CHAR_UPPER;
+	return CHAR_LETTER;
+}
+
+
+static inline int32
+bonus_for(char_class previous, char_class current)
+{
+	if ((previous == CHAR_WHITE || previous == CHAR_NON_WORD)
+		&& current != CHAR_WHITE && current != CHAR_NON_WORD)
+		return kBonusBoundary;
+	if ((previous == CHAR_LOWER && current == CHAR_UPPER)
+		|| (previous != CHAR_NUMBER && current == CHAR_NUMBER))
+		return kBonusCamel;
+	if (current == CHAR_WHITE || current == CHAR_NON_WORD)
+		return kBonusNonWord;
+	return 0;
+}
+
+
+static inline const uint8*
+previous_char(const uint8* text, const uint8* begin)
+{
+	do {
+		text--;
+	} while (text > begin && (*text & 0xc0) == 0x80);
+	return text;
+}
+
+
+FuzzyMatcher::FuzzyMatcher(const char* query)
+{
+	const uint8* text = (const uint8*)query;
+	const uint8* end = text + strlen(query);
+	while (text < end)
+		fQuery.push_back(fold_char(read_char(text, end)));
+}
+
+
+bool
+FuzzyMatcher::Score(const char* text, size_t length, int32* _score) const
+{
+	if (fQuery.empty()) {
+		*_score = 0;
+		return true;
+	}
+
+	const uint8* begin = (const uint8*)text;
+	const uint8* end = begin + std::min(length, kFuzzyScanLimit);
+	size_t count = fQuery.size();
+
+	// Find the first occurrence of the query as a subsequence...
+	size_t index = 0;
+	const uint8* position = begin;
+	while (position < end) {
+		uint32 c = *position;
+		if (c < 0x80) {
+			position++;
+			if (c >= 'A' && c <= 'Z')
+				c += 'a' - 'A';
+		} else
+			c = fold_char(read_char(position, end));
+
+		if (c == fQuery[index] && ++index == count)
+			break;
+	}
+	if (index < count)
+		return false;
+
+	// ... and go back from its end to find the shortest window
+	const uint8* windowEnd = position;
+	const uint8* windowStart = position;
+	index = count;
+	while (index > 0) {
+		windowStart = previous_char(windowStart, begin);
+		const uint8* next = windowStart;
+		if (fold_char(read_char(next, end)) == fQuery[index - 1])
+			index--;
+	}
+
+	char_class previousClass = CHAR_WHITE;
+	if (windowStart > begin) {
+		const uint8* previous = previous_char(windowStart, begin);
+		previousClass = class_of(read_char(previous, end));
+	}
+
+	int32 score = 0;
+	int32 consecutive = 0;
+	int32 firstBonus = 0;
+	bool inGap = false;
+	index = 0;
+	position = windowStart;
+	while (position < windowEnd && index < count) {
+		uint32 c = read_char(position, end);
+		char_class currentClass = class_of(c);
+
+		if (fold_char(c) == fQuery[index]) {
+			score += kScoreMatch;
+			int32 bonus = bonus_for(previousClass, currentClass);
+			if (consecutive == 0)
+				firstBonus = bonus;
+			else {
+				if (bonus >= kBonusBoundary && bonus > firstBonus)
+					firstBonus = bonus;
+				bonus = std::max(std::max(bonus, firstBonus), kBonusConsecutive);
+			}
+			score += index == 0 ? bonus * kBonusFirstCharMultiplier : bonus;
+			inGap = false;
+			consecutive++;
+			index++;
+		} else {
+			score += inGap ? kScoreGapExtension : kScoreGapStart;
+			inGap = true;
+			consecutive = 0;
+			firstBonus = 0;
+		}
+		previousClass = currentClass;
+	}
+
+	*_score = score;
+	return true;
+}
+
+
+// #pragma mark - TopResults
+
+
+static inline bool
+is_better(const FuzzyResult& a, const FuzzyResult& b)
+{
+	return a.score > b.score || (a.score == b.score && a.index < b.index);
+}
+
+
+TopResults::TopResults(int32 count)
+	:
+	fCount(count > 0 ? count : 0)
+{
+	fHeap.reserve(fCount);
+}
+
+
+void
+TopResults::Add(int32 index, int32 score)
+{
+	FuzzyResult result = { index, score };
+	if (fHeap.size() < fCount) {
+		fHeap.push_back(result);
+		std::push_heap(fHeap.begin(), fHeap.end(), is_better);
+	} else if (fCount > 0 && is_better(result, fHeap.front())) {
+		std::pop_heap(fHeap.begin(), fHeap.end(), is_better);
+		fHeap.back() = result;
+		std::push_heap(fHeap.begin(), fHeap.end(), is_better);
+	}
+}
+
+
+void
+TopResults::GetResults(std::vector<FuzzyResult>& results)
+{
+	results = fHeap;
+	// Sorting just the top K
+	std::sort_heap(results.begin(), results.end(), is_better);
+}
+
+
+// #pragma mark -
+
+
+int32
+recency_bonus(bigtime_t age)
+{
+	// Full bonus for a fresh clip, half after an hour, a tenth after 9 hours
+	if (age < 0)
+		age = 0;
+	return kRecencyBonus * 3600 / (3600 + age);
+}
+
+
+void
+rank_clips(const ClipStore& store, const char* query, bigtime_t now,
+	int32 count, std::vector<FuzzyResult>& results)
+{
+	TRACE_SPAN("rank_clips");
+
+	FuzzyMatcher matcher(query);
+	TopResults top(count);
+
+	for (int32 i = 0; i < store.CountClips(); i++) {
+		const ClipRecord* record = store.ClipAt(i);
+		int32 score;
+		if (!matcher.Score(record->GetClipData(), record->GetClipLength(),
+				&score))
+			continue;
+
+		top.Add(i, score + recency_bonus(now - record->GetTimeAdded()));
+	}
+	top.GetResults(results);
+}
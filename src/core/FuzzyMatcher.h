@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Fuzzy matching in the style of fzf: the query's characters have to
+ * appear in order, and matches score higher the more compact they are and
+ * the more of them start words, follow camel case humps or run on.
+ */
+
+#ifndef FUZZYMATCHER_H
+#define FUZZYMATCHER_H
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "CoreDefs.h"
+
+
+class ClipStore;
+
+
+struct FuzzyResult {
+	int32		index;
+	int32		score;
+};
+
+
+class FuzzyMatcher {
+public:
+						FuzzyMatcher(const char* query);
+
+	bool				IsEmpty() const { return fQuery.empty(); }
+
+	// Returns false if the text doesn't contain the query's characters in
+	// order. Only the first kFuzzyScanLimit bytes are looked at.
+	bool				Score(const char* text, size_t length,
+							int32* _score) const;
+
+private:
+	std::vector<uint32>	fQuery;			// Folded code points
+};
+
+
+// Keeps the 'count' best results seen, without sorting all of them
+class TopResults {
+public:
+						TopResults(int32 count);
+
+	void				Add(int32 index, int32 score);
+	// Best first, ties go to the lower index
+	void				GetResults(std::vector<FuzzyResult>& results);
+
+private:
+	std::vector<FuzzyResult> fHeap;		// The worst result is on top
+	size_t				fCount;
+};
+
+
+static const size_t kFuzzyScanLimit = 64 * 1024;
+
+// A bonus for recently added clips, in score points
+int32	recency_bonus(bigtime_t age);
+
+// Ranks the clips of the store by fuzzy score plus recency bonus and
+// returns the best 'count' ones.
+void	rank_clips(const ClipStore& store, const char* query, bigtime_t now,
+			int32 count, std::vector<FuzzyResult>& results);
+
+#endif // FUZZYMATCHER_H
@@ -0,0 +1,564 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <string.h>
+#include <unistd.h>
+
+#include "ClipHash.h"
+#include "HistoryJournal.h"
+#include "Instrumentation.h"
+#include "RecordFile.h"
+#include "Tracing.h"
+
+
+static const uint32 kJournalVersion = 3;
+
+// Compact when there are more than twice as many records as clips
+static const int32 kCompactSlack = 256;
+
+// A journal starts with a snapshot of the store that can be used straight
+// from a mapping of the file: the header, the origins, the contents of all
+// clips in one record, an entry for each clip, oldest first, and which ones
+// were pasted. The change records follow. The clip contents aren't
+// checksummed as a whole; each entry carries the hash of its clip, which
+// is verified on replay.
+enum {
+	RECORD_JOURNAL = 'JRNL',	// uint32 version
+	RECORD_ORIGIN = 'ORIG',		// uint32 id, string origin
+	RECORD_CLIPS = 'CLPS' | kUncheckedPayload,
+	RECORD_ENTRY = 'ENTR',		// uint64 offset into the clips, uint64 hash,
+								// int64 added, uint32 length, uint32 origin id,
+								// string title
+	RECORD_BLOB_ENTRY = 'BENT',	// uint64 hash, int64 added, uint64 length,
+								// uint32 origin id, string title, preview
+	RECORD_ADD = 'ADD ',		// uint64 hash, int64 added, string clip, title,
+								// origin
+	RECORD_ADD_BLOB = 'ADDB',	// uint64 hash, int64 added, uint64 length,
+								// string title, origin, preview
+	RECORD_REMOVE = 'REMV',		// uint64 hash
+	RECORD_MOVE = 'MOVE',		// uint64 hash, int64 added
+	RECORD_TITLE = 'TITL',		// uint64 hash, string title
+	RECORD_CLEAR = 'CLR ',
+	RECORD_QUIT = 'QUIT',		// int64 quit time
+	RECORD_PASTED = 'PSTD'		// uint64 hash, in snapshots (moves imply it)
+};
+
+// Origin ids beyond this are taken as garbage
+static const uint32 kMaxOrigins = 1 << 20;
+
+
+static void
+add_record(std::string& buffer, const ClipRecord* record)
+{
+	RecordWriter writer(buffer);
+	if (record->IsBlob()) {
+		// The contents are in the blob store already
+		writer.StartRecord(RECORD_ADD_BLOB);
+		writer.PutUInt64(record->GetHash());
+		writer.PutUInt64(record->GetTimeAdded());
+		writer.PutUInt64(record->GetClipLength());
+		writer.PutString(record->GetTitle());
+		writer.PutString(record->GetOrigin());
+		writer.PutString(record->GetPreviewData(), record->GetPreviewLength());
+		writer.EndRecord();
+		return;
+	}
+
+	writer.StartRecord(RECORD_ADD);
+	writer.PutUInt64(record->GetHash());
+	writer.PutUInt64(record->GetTimeAdded());
+	writer.PutString(record->GetClipData(), record->GetClipLength());
+	writer.PutString(record->GetTitle());
+	writer.PutString(record->GetOrigin());
+	writer.EndRecord();
+}
+
+
+HistoryJournal::HistoryJournal(FileWriter& writer)
+	:
+	fWriter(writer),
+	fStore(NULL),
+	fRecords(0)
+{
+}
+
+
+HistoryJournal::~HistoryJournal()
+{
+	_Detach();
+}
+
+
+status_t
+HistoryJournal::Open(const char* path, ClipStore& store, bigtime_t* _quitTime)
+{
+	TRACE_SPAN("HistoryJournal::Open");
+
+	_Detach();
+	// Anything still pending for the journal has to be in it
+	fWriter.Flush();
+
+	std::shared_ptr<MappedFile> mapping(new MappedFile(path));
+	if (mapping->InitCheck() != B_OK)
+		return mapping->InitCheck();
+
+	fPath = path;
+	fStore = &store;
+	store.SetListener(NULL);
+
+	// Replayed removals mustn't delete blobs that later records refer to.
+	// Blobs that end up unused are left to ClipStore::PruneBlobs().
+	BlobStore* blobs = store.GetBlobStore();
+	store.SetBlobStore(NULL);
+	status_t status = _Replay(mapping, blobs, _quitTime);
+	store.SetBlobStore(blobs);
+	if (status != B_OK) {
+		fStore = NULL;
+		return status;
+	}
+
+	store.SetListener(this);
+	return B_OK;
+}
+
+
+void
+HistoryJournal::Create(const char* path, ClipStore& store)
+{
+	_Detach();
+
+	fPath = path;
+	fStore = &store;
+	_Compact();
+	store.SetListener(this);
+}
+
+
+void
+HistoryJournal::Attach(const char* path, ClipStore& store, int32 records)
+{
+	_Detach();
+
+	fPath = path;
+	fStore = &store;
+	fRecords = records;
+	// Until the replayed clips are merged, the store only holds a few of
+	// them. Compacting now would drop the rest.
+	for (int32 i = store.CountClips() - 1; i >= 0; i--) {
+		std::string buffer;
+		add_record(buffer, store.ClipAt(i));
+		_Append(buffer, false);
+	}
+	store.SetListener(this);
+}
+
+
+void
+HistoryJournal::Close(bigtime_t quitTime)
+{
+	INSTRUMENT_SCOPE("save_history");
+
+	if (fStore != NULL) {
+		std::string buffer;
+		RecordWriter writer(buffer);
+		writer.StartRecord(RECORD_QUIT);
+		writer.PutUInt64(quitTime);
+		writer.EndRecord();
+		_Append(buffer, false);
+	}
+	_Detach();
+}
+
+
+void
+HistoryJournal::ClipAdded(const ClipRecord* record)
+{
+	INSTRUMENT_SCOPE("save_history");
+
+	std::string buffer;
+	add_record(buffer, record);
+	_Append(buffer, true);
+}
+
+
+void
+HistoryJournal::ClipRemoved(const ClipRecord* record)
+{
+	INSTRUMENT_SCOPE("save_history");
+
+	std::string buffer;
+	RecordWriter writer(buffer);
+	writer.StartRecord(RECORD_REMOVE);
+	writer.PutUInt64(record->GetHash());
+	writer.EndRecord();
+
+	// The record is still in the store, it can't be snapshot now
+	_Append(buffer, false);
+}
+
+
+void
+HistoryJournal::ClipMoved(const ClipRecord* record)
+{
+	INSTRUMENT_SCOPE("save_history");
+
+	std::string buffer;
+	RecordWriter writer(buffer);
+	writer.StartRecord(RECORD_MOVE);
+	writer.PutUInt64(record->GetHash());
+	writer.PutUInt64(record->GetTimeAdded());
+	writer.EndRecord();
+	_Append(buffer, true);
+}
+
+
+void
+HistoryJournal::ClipRetitled(const ClipRecord* record)
+{
+	INSTRUMENT_SCOPE("save_history");
+
+	std::string buffer;
+	RecordWriter writer(buffer);
+	writer.StartRecord(RECORD_TITLE);
+	writer.PutUInt64(record->GetHash());
+	writer.PutString(record->GetTitle());
+	writer.EndRecord();
+	_Append(buffer, true);
+}
+
+
+void
+HistoryJournal::StoreEmptied()
+{
+	INSTRUMENT_SCOPE("save_history");
+
+	std::string buffer;
+	RecordWriter writer(buffer);
+	writer.StartRecord(RECORD_CLEAR);
+	writer.EndRecord();
+	_Append(buffer, true);
+}
+
+
+status_t
+HistoryJournal::_Replay(const std::shared_ptr<MappedFile>& mapping,
+	BlobStore* blobs, bigtime_t* _quitTime)
+{
+	RecordScanner scanner(mapping->Data(), mapping->Size());
+	uint32 type;
+	const char* data;
+	uint32 size;
+	if (!scanner.Next(type, data, size))
+		return B_BAD_DATA;
+
+	// Without its header the journal is salvaged as far as possible
+	bool damaged = scanner.CountDamaged() > 0;
+	if (type == RECORD_JOURNAL) {
+		uint32 version;
+		RecordReader reader(data, size);
+		if (!reader.GetUInt32(version) || version != kJournalVersion)
+			return B_BAD_DATA;
+	} else if (!damaged)
+		return B_BAD_DATA;
+
+	std::vector<std::string> origins;
+	const char* clips = NULL;
+	uint64 clipsSize = 0;
+	bigtime_t lastTime = 0;
+	fRecords = 0;
+
+	do {
+		RecordReader reader(data, size);
+		const char* clip;
+		uint32 length;
+		std::string title;
+		std::string origin;
+		std::string preview;
+		uint32 id;
+		uint64 offset;
+		uint64 hash;
+		uint64 time;
+		uint64 blobLength;
+		bool ok = true;
+
+		switch (type) {
+			case RECORD_JOURNAL:
+				break;
+			case RECORD_ORIGIN:
+				ok = reader.GetUInt32(id) && id < kMaxOrigins
+					&& reader.GetString(origin);
+				if (ok) {
+					if (id >= origins.size())
+						origins.resize(id + 1);
+					origins[id].swap(origin);
+				}
+				break;
+			case RECORD_CLIPS:
+				clips = data;
+				clipsSize = size;
+				break;
+			case RECORD_ENTRY:
+				ok = reader.GetUInt64(offset) && reader.GetUInt64(hash)
+					&& reader.GetUInt64(time) && reader.GetUInt32(length)
+					&& reader.GetUInt32(id) && reader.GetString(title)
+					&& offset <= clipsSize && clipsSize - offset >= length;
+				if (ok && hash_clip(clips + offset, length) != hash) {
+					// The clip was damaged, its entry is dropped with it
+					damaged = true;
+					break;
+				}
+				if (ok) {
+					if (id < origins.size())
+						origin = origins[id];
+					fStore->RemoveClip(fStore->IndexOf(fStore->FindHash(hash)));
+					fStore->AddRecord(new ClipRecord(mapping, clips + offset,
+						length, hash, title, origin, time, time));
+					lastTime = std::max(lastTime, (bigtime_t)time);
+				}
+				break;
+			case RECORD_BLOB_ENTRY:
+				ok = reader.GetUInt64(hash) && reader.GetUInt64(time)
+					&& reader.GetUInt64(blobLength) && reader.GetUInt32(id)
+					&& reader.GetString(title) && reader.GetString(preview);
+				if (ok) {
+					if (id < origins.size())
+						origin = origins[id];
+					_AddBlob(blobs, hash, blobLength, preview, title, origin, time);
+					lastTime = std::max(lastTime, (bigtime_t)time);
+				}
+				break;
+			case RECORD_ADD_BLOB:
+				ok = reader.GetUInt64(hash) && reader.GetUInt64(time)
+					&& reader.GetUInt64(blobLength) && reader.GetString(title)
+					&& reader.GetString(origin) && reader.GetString(preview);
+				if (ok) {
+					_AddBlob(blobs, hash, blobLength, preview, title, origin, time);
+					lastTime = time;
+				}
+				break;
+			case RECORD_ADD:
+				ok = reader.GetUInt64(hash) && reader.GetUInt64(time)
+					&& reader.GetString(clip, length) && reader.GetString(title)
+					&& reader.GetString(origin);
+				if (ok) {
+					fStore->RemoveClip(fStore->IndexOf(fStore->FindHash(hash)));
+					fStore->AddRecord(new ClipRecord(mapping, clip, length, hash,
+						title, origin, time, time));
+					lastTime = time;
+				}
+				break;
+			case RECORD_REMOVE:
+				ok = reader.GetUInt64(hash);
+				if (ok)
+					fStore->RemoveClip(fStore->IndexOf(fStore->FindHash(hash)));
+				break;
+			case RECORD_MOVE:
+				ok = reader.GetUInt64(hash) && reader.GetUInt64(time);
+				if (ok) {
+					fStore->MoveToTop(fStore->IndexOf(fStore->FindHash(hash)), time);
+					lastTime = time;
+				}
+				break;
+			case RECORD_TITLE:
+				ok = reader.GetUInt64(hash) && reader.GetString(title);
+				if (ok)
+					fStore->SetTitle(fStore->FindHash(hash), title);
+				break;
+			case RECORD_PASTED:
+				ok = reader.GetUInt64(hash);
+				if (ok && fStore->FindHash(hash) != NULL)
+					fStore->FindHash(hash)->SetPasted(true);
+				break;
+			case RECORD_CLEAR:
+				fStore->MakeEmpty();
+				break;
+			case RECORD_QUIT:
+				ok = reader.GetUInt64(time);
+				if (ok)
+					lastTime = time;
+				break;
+			default:
+				// Unknown records are skipped
+				break;
+		}
+
+		// A record that checks out but can't be read wasn't written by us
+		if (!ok)
+			damaged = true;
+		fRecords++;
+	} while (scanner.Next(type, data, size));
+
+	if (_quitTime != NULL)
+		*_quitTime = lastTime;
+
+	if (damaged || scanner.CountDamaged() > 0) {
+		// Keep only what's still intact and write it out anew
+		_Compact();
+		return B_OK;
+	}
+
+	// Cut off a record torn by a crash, so appending continues after the
+	// last complete one. The mapping never gets accessed beyond it.
+	if (scanner.End() < mapping->Size()
+		&& truncate(fPath.c_str(), scanner.End()) != 0)
+		return B_IO_ERROR;
+
+	return B_OK;
+}
+
+
+void
+HistoryJournal::_AddBlob(BlobStore* blobs, uint64 hash, uint64 length,
+	const std::string& preview, const std::string& title,
+	const std::string& origin, bigtime_t added)
+{
+	fStore->RemoveClip(fStore->IndexOf(fStore->FindHash(hash)));
+
+	// A blob that went missing takes its clip with it
+	std::shared_ptr<MappedFile> blob;
+	if (blobs != NULL)
+		blob = blobs->Map(hash);
+	if (!blob || blob->Size() != length)
+		return;
+
+	fStore->AddRecord(new ClipRecord(blob, hash, preview, title, origin, added,
+		added));
+}
+
+
+void
+HistoryJournal::_Append(const std::string& record, bool mayCompact)
+{
+	if (fStore == NULL)
+		return;
+
+	fWriter.Append(fPath, record);
+	fRecords++;
+
+	if (mayCompact && fRecords > 2 * fStore->CountClips() + kCompactSlack)
+		_Compact();
+}
+
+
+void
+HistoryJournal::_Detach()
+{
+	if (fStore != NULL) {
+		fStore->SetListener(NULL);
+		fStore = NULL;
+	}
+	fRecords = 0;
+}
+
+
+void
+HistoryJournal::_Compact()
+{
+	// Copying the clips is cheap compared to writing them, that's left
+	// to the writer. Records logged from now on get appended to the
+	// snapshot.
+	std::string snapshot;
+	_Snapshot(snapshot);
+	fWriter.Replace(fPath, std::move(snapshot));
+	fRecords = fStore->CountClips();
+}
+
+
+void
+HistoryJournal::_Snapshot(std::string& buffer) const
+{
+	int32 count = fStore->CountClips();
+
+	// Oldest first, replaying adds each one at the top
+	std::vector<const ClipRecord*> records;
+	records.reserve(count);
+	for (int32 i = count - 1; i >= 0; i--)
+		records.push_back(fStore->ClipAt(i));
+
+	buffer.clear();
+	RecordWriter writer(buffer);
+	writer.StartRecord(RECORD_JOURNAL);
+	writer.PutUInt32(kJournalVersion);
+	writer.EndRecord();
+
+	std::unordered_map<std::string, uint32> originIds;
+	std::vector<uint32> recordOrigins(count);
+	for (int32 i = 0; i < count; i++) {
+		const std::string& origin = records[i]->GetOrigin();
+		std::unordered_map<std::string, uint32>::iterator found
+			= originIds.find(origin);
+		if (found == originIds.end()) {
+			uint32 id = originIds.size();
+			found = originIds.insert(std::make_pair(origin, id)).first;
+
+			writer.StartRecord(RECORD_ORIGIN);
+			writer.PutUInt32(id);
+			writer.PutString(origin);
+			writer.EndRecord();
+		}
+		recordOrigins[i] = found->second;
+	}
+
+	// The clips come from the mapping of the old journal. One that got
+	// damaged since is left out rather than carried over with its hash.
+	std::vector<uint64> offsets(count);
+	std::vector<bool> intact(count, true);
+	writer.StartRecord(RECORD_CLIPS);
+	size_t clips = writer.Position();
+	for (int32 i = 0; i < count; i++) {
+		const ClipRecord* record = records[i];
+		offsets[i] = writer.Position() - clips;
+		if (record->IsBlob())
+			continue;
+		if (hash_clip(record->GetClipData(), record->GetClipLength())
+				!= record->GetHash()) {
+			intact[i] = false;
+			continue;
+		}
+		writer.PutRaw(record->GetClipData(), record->GetClipLength());
+	}
+	writer.EndRecord();
+
+	for (int32 i = 0; i < count; i++) {
+		const ClipRecord* record = records[i];
+		if (!intact[i])
+			continue;
+		if (record->IsBlob()) {
+			writer.StartRecord(RECORD_BLOB_ENTRY);
+			writer.PutUInt64(record->GetHash());
+			writer.PutUInt64(record->GetTimeAdded());
+			writer.PutUInt64(record->GetClipLength());
+			writer.PutUInt32(recordOrigins[i]);
+			writer.PutString(record->GetTitle());
+			writer.PutString(record->GetPreviewData(),
+				record->GetPreviewLength());
+			writer.EndRecord();
+			continue;
+		}
+
+		writer.StartRecord(RECORD_ENTRY);
+		writer.PutUInt64(offsets[i]);
+		writer.PutUInt64(record->GetHash());
+		writer.PutUInt64(record->GetTimeAdded());
+		writer.PutUInt32(record->GetClipLength());
+		writer.PutUInt32(recordOrigins[i]);
+		writer.PutString(record->GetTitle());
+		writer.EndRecord();
+	}
+
+	for (int32 i = 0; i < count; i++) {
+		if (!intact[i] || !records[i]->WasPasted())
+			continue;
+
+		writer.StartRecord(RECORD_PASTED);
+		writer.PutUInt64(records[i]->GetHash());
+		writer.EndRecord();
+	}
+}
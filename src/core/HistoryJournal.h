@@ -0,0 +1,73 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Persists a ClipStore as an append-only log of its changes, so saving a
+ * new clip doesn't mean rewriting the whole history. Once the log holds
+ * too many stale records, it's replaced by a snapshot of the store. The
+ * journal is memory mapped when it's opened, and the clips are left in
+ * the mapping. All writing is left to a FileWriter. The journal is a
+ * record file, so a damaged one is salvaged as far as it's intact.
+ */
+
+#ifndef HISTORYJOURNAL_H
+#define HISTORYJOURNAL_H
+
+#include <memory>
+#include <string>
+
+#include "ClipStore.h"
+#include "FileWriter.h"
+
+
+class HistoryJournal : public ClipStoreListener {
+public:
+						HistoryJournal(FileWriter& writer);
+	virtual				~HistoryJournal();
+
+	// Replays the journal into the (empty) store and keeps logging its
+	// changes from then on. Returns B_ENTRY_NOT_FOUND if there's no
+	// journal yet. '_quitTime' is set to the time of the last Close(), or
+	// of the last add or move after it if the app didn't quit cleanly.
+	// A damaged journal is rewritten with the clips that are left.
+	status_t			Open(const char* path, ClipStore& store,
+							bigtime_t* _quitTime);
+	// Starts a new journal with the current contents of the store
+	void				Create(const char* path, ClipStore& store);
+	// Continues a journal of 'records' records that was replayed into
+	// another store, see HistoryLoader. The clips already in the store are
+	// newer than anything in the journal and get logged first.
+	void				Attach(const char* path, ClipStore& store,
+							int32 records);
+	// Logs the quit time and stops listening to the store. The writer
+	// still has to be flushed.
+	void				Close(bigtime_t quitTime);
+
+	bool				IsOpen() const { return fStore != NULL; }
+	int32				CountRecords() const { return fRecords; }
+
+	virtual	void		ClipAdded(const ClipRecord* record);
+	virtual	void		ClipRemoved(const ClipRecord* record);
+	virtual	void		ClipMoved(const ClipRecord* record);
+	virtual	void		ClipRetitled(const ClipRecord* record);
+	virtual	void		StoreEmptied();
+
+private:
+	status_t			_Replay(const std::shared_ptr<MappedFile>& mapping,
+							BlobStore* blobs, bigtime_t* _quitTime);
+	void				_AddBlob(BlobStore* blobs, uint64 hash, uint64 length,
+							const std::string& preview,
+							const std::string& title, const std::string& origin,
+							bigtime_t added);
+	void				_Append(const std::string& record, bool mayCompact);
+	void				_Detach();
+	void				_Compact();
+	void				_Snapshot(std::string& buffer) const;
+
+	FileWriter&			fWriter;
+	ClipStore*			fStore;
+	std::string			fPath;
+	int32				fRecords;
+};
+
+#endif // HISTORYJOURNAL_H
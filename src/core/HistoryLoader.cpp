@@ -0,0 +1,91 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include "HistoryJournal.h"
+#include "HistoryLoader.h"
+#include "Instrumentation.h"
+#include "Tracing.h"
+
+
+HistoryLoader::HistoryLoader(FileWriter& writer)
+	:
+	fWriter(writer),
+	fStore(0),
+	fStatus(B_NO_INIT),
+	fRecords(0),
+	fQuitTime(0),
+	fWaitedFor(false)
+{
+}
+
+
+HistoryLoader::~HistoryLoader()
+{
+	Wait();
+	Discard();
+}
+
+
+void
+HistoryLoader::Start(const char* path, const char* indexPath,
+	const ClipStore& like, const LoadedFunction& loaded)
+{
+	Wait();
+	Discard();
+
+	fPath = path;
+	fIndexPath = indexPath;
+	fLoaded = loaded;
+	fStatus = B_NO_INIT;
+	fRecords = 0;
+	fQuitTime = 0;
+	fWaitedFor = false;
+
+	fStore.SetLimit(like.Limit());
+	fStore.SetByteLimit(like.ByteLimit());
+	fStore.SetBlobStore(like.GetBlobStore());
+	fThread = std::thread(&HistoryLoader::_Run, this);
+}
+
+
+status_t
+HistoryLoader::Wait()
+{
+	fWaitedFor = true;
+	if (fThread.joinable())
+		fThread.join();
+	return fStatus;
+}
+
+
+void
+HistoryLoader::Discard()
+{
+	// The blobs may belong to clips that were merged already
+	fStore.SetBlobStore(NULL);
+	fStore.MakeEmpty();
+}
+
+
+void
+HistoryLoader::_Run()
+{
+	TRACE_THREAD("history loader");
+	TRACE_SPAN("HistoryLoader::_Run");
+	INSTRUMENT_SCOPE("load_history");
+
+	// Don't index clip by clip, LoadIndex() reads it all at once
+	fStore.SuspendIndex();
+	{
+		// Only replays, the journal is continued with Attach()
+		HistoryJournal journal(fWriter);
+		fStatus = journal.Open(fPath.c_str(), fStore, &fQuitTime);
+		fRecords = journal.CountRecords();
+	}
+	fStore.LoadIndex(fIndexPath.c_str());
+
+	if (fLoaded)
+		fLoaded(fStatus);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Loads the history in the background, so a large one doesn't hold up
+ * capturing new clips at startup. The journal is replayed into a store of
+ * the loader's own, and its trigram index is read back, in a thread of
+ * its own. The clips that came in meanwhile are then logged with
+ * HistoryJournal::Attach() and put on top of the loaded ones with
+ * ClipStore::MergeOlder().
+ */
+
+#ifndef HISTORYLOADER_H
+#define HISTORYLOADER_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "ClipStore.h"
+#include "FileWriter.h"
+
+
+class HistoryLoader {
+public:
+	typedef std::function<void(status_t)> LoadedFunction;
+
+						HistoryLoader(FileWriter& writer);
+						~HistoryLoader();
+
+	// Replays the journal at 'path' with the limits and the blob store of
+	// 'like', and loads the index at 'indexPath' (see
+	// ClipStore::LoadIndex()). 'loaded' is called from the loading thread
+	// once it's done, with the result of HistoryJournal::Open().
+	void				Start(const char* path, const char* indexPath,
+							const ClipStore& like,
+							const LoadedFunction& loaded);
+	// Waits for the loading thread, returns what 'loaded' got
+	status_t			Wait();
+	// Whether Wait() was called, so 'loaded' doesn't have to block on
+	// whoever is waiting for it
+	bool				IsWaitedFor() const { return fWaitedFor; }
+
+	// Only to be used once the loading is done
+	ClipStore&			Store() { return fStore; }
+	// Of the replayed journal, see HistoryJournal::CountRecords()
+	int32				CountRecords() const { return fRecords; }
+	// See HistoryJournal::Open()
+	bigtime_t			QuitTime() const { return fQuitTime; }
+	// Drops the loaded clips, their blobs are left alone
+	void				Discard();
+
+private:
+	void				_Run();
+
+	FileWriter&			fWriter;
+	ClipStore			fStore;
+	std::string			fPath;
+	std::string			fIndexPath;
+	LoadedFunction		fLoaded;
+	status_t			fStatus;
+	int32				fRecords;
+	bigtime_t			fQuitTime;
+	std::atomic<bool>	fWaitedFor;
+	std::thread			fThread;
+};
+
+#endif // HISTORYLOADER_H
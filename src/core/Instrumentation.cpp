@@ -0,0 +1,265 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <mutex>
+#include <new>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Instrumentation.h"
+
+
+#ifdef CLIPDINGER_INSTRUMENT
+
+// Per thread, so a scope doesn't count the work of e.g. the FileWriter
+static thread_local int64 tAllocations = 0;
+static thread_local int64 tBytesAllocated = 0;
+static thread_local int64 tBytesCopied = 0;
+
+
+struct scope_stats {
+	const char*			name;
+	int64				events;
+	instrument_counters	total;
+};
+
+
+// A fixed table, so that counting a scope doesn't allocate itself
+static const int32 kMaxScopes = 32;
+static scope_stats sScopes[kMaxScopes];
+static int32 sScopeCount = 0;
+static std::mutex sScopeLock;
+
+
+static scope_stats*
+find_scope(const char* name)
+{
+	for (int32 i = 0; i < sScopeCount; i++) {
+		if (strcmp(sScopes[i].name, name) == 0)
+			return &sScopes[i];
+	}
+	if (sScopeCount == kMaxScopes)
+		return NULL;
+
+	scope_stats* stats = &sScopes[sScopeCount++];
+	memset(stats, 0, sizeof(scope_stats));
+	stats->name = name;
+	return stats;
+}
+
+
+static void*
+counted_alloc(size_t size)
+{
+	tAllocations++;
+	tBytesAllocated += size;
+	return malloc(size > 0 ? size : 1);
+}
+
+
+void*
+operator new(size_t size)
+{
+	void* memory = counted_alloc(size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+
+void*
+operator new[](size_t size)
+{
+	void* memory = counted_alloc(size);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+
+void*
+operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return counted_alloc(size);
+}
+
+
+void*
+operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return counted_alloc(size);
+}
+
+
+void
+operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+
+void
+operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+
+void
+operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	free(memory);
+}
+
+
+void
+operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	free(memory);
+}
+
+
+InstrumentScope::InstrumentScope(const char* name)
+	:
+	fName(name)
+{
+	instrument_get_counters(fStart);
+}
+
+
+InstrumentScope::~InstrumentScope()
+{
+	instrument_counters end;
+	instrument_get_counters(end);
+
+	std::lock_guard<std::mutex> _(sScopeLock);
+	scope_stats* stats = find_scope(fName);
+	if (stats == NULL)
+		return;
+
+	stats->events++;
+	stats->total.allocations += end.allocations - fStart.allocations;
+	stats->total.bytes_allocated += end.bytes_allocated
+		- fStart.bytes_allocated;
+	stats->total.bytes_copied += end.bytes_copied - fStart.bytes_copied;
+}
+
+
+bool
+instrument_enabled()
+{
+	return true;
+}
+
+
+void
+instrument_get_counters(instrument_counters& counters)
+{
+	counters.allocations = tAllocations;
+	counters.bytes_allocated = tBytesAllocated;
+	counters.bytes_copied = tBytesCopied;
+}
+
+
+void
+instrument_copied(size_t bytes)
+{
+	tBytesCopied += bytes;
+}
+
+
+std::string
+instrument_report()
+{
+	std::string report;
+	char line[256];
+	snprintf(line, sizeof(line), "%-20s %8s %12s %14s %14s %12s %12s\n",
+		"scope", "events", "allocs", "KB allocated", "KB copied",
+		"allocs/event", "KB/event");
+	report += line;
+
+	std::lock_guard<std::mutex> _(sScopeLock);
+	for (int32 i = 0; i < sScopeCount; i++) {
+		const scope_stats& stats = sScopes[i];
+		double events = stats.events > 0 ? stats.events : 1;
+		snprintf(line, sizeof(line),
+			"%-20s %8lld %12lld %14.1f %14.1f %12.1f %12.1f\n", stats.name,
+			(long long)stats.events, (long long)stats.total.allocations,
+			stats.total.bytes_allocated / 1024.0,
+			stats.total.bytes_copied / 1024.0,
+			stats.total.allocations / events,
+			(stats.total.bytes_allocated + stats.total.bytes_copied)
+				/ 1024.0 / events);
+		report += line;
+	}
+	return report;
+}
+
+
+void
+instrument_reset()
+{
+	std::lock_guard<std::mutex> _(sScopeLock);
+	sScopeCount = 0;
+}
+
+
+#else // !CLIPDINGER_INSTRUMENT
+
+
+bool
+instrument_enabled()
+{
+	return false;
+}
+
+
+void
+instrument_get_counters(instrument_counters& counters)
+{
+	counters.allocations = 0;
+	counters.bytes_allocated = 0;
+	counters.bytes_copied = 0;
+}
+
+
+void
+instrument_copied(size_t /*bytes*/)
+{
+}
+
+
+std::string
+instrument_report()
+{
+	return "Not counting, this build doesn't define CLIPDINGER_INSTRUMENT.\n";
+}
+
+
+void
+instrument_reset()
+{
+}
+
+
+#endif // CLIPDINGER_INSTRUMENT
+
+
+status_t
+instrument_dump(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return B_ERROR;
+
+	std::string report = instrument_report();
+	bool written = fwrite(report.data(), 1, report.length(), file)
+		== report.length();
+	if (fclose(file) != 0 || !written)
+		return B_IO_ERROR;
+	return B_OK;
+}
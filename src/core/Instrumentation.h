@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Opt-in counters for memory churn on the clip hot paths. Built with
+ * CLIPDINGER_INSTRUMENT defined ("make INSTRUMENT=1" in src/, and always
+ * for the headless churn_benchmark), operator new counts the allocations
+ * of every thread and the places that copy clip bytes report them. A named
+ * scope adds up what its own thread allocated and copied while it was
+ * alive. Scopes may nest, the inner scope's counts are part of the outer
+ * one's as well.
+ *
+ * Without CLIPDINGER_INSTRUMENT the macros compile to nothing.
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stddef.h>
+
+#include <string>
+
+#include "CoreDefs.h"
+
+
+struct instrument_counters {
+	int64		allocations;
+	int64		bytes_allocated;
+	int64		bytes_copied;
+};
+
+
+#ifdef CLIPDINGER_INSTRUMENT
+
+class InstrumentScope {
+public:
+						InstrumentScope(const char* name);
+						~InstrumentScope();
+
+private:
+						InstrumentScope(const InstrumentScope&);
+			InstrumentScope& operator=(const InstrumentScope&);
+
+	const char*			fName;		// A string literal
+	instrument_counters	fStart;
+};
+
+#define INSTRUMENT_SCOPE(name) InstrumentScope _instrumentScope(name)
+#define INSTRUMENT_COPY(bytes) instrument_copied(bytes)
+
+#else
+
+#define INSTRUMENT_SCOPE(name)
+#define INSTRUMENT_COPY(bytes)
+
+#endif // CLIPDINGER_INSTRUMENT
+
+
+bool		instrument_enabled();
+
+// What the calling thread allocated and copied so far
+void		instrument_get_counters(instrument_counters& counters);
+void		instrument_copied(size_t bytes);
+
+// One line per scope with its totals and averages per event
+std::string	instrument_report();
+status_t	instrument_dump(const char* path);
+void		instrument_reset();
+
+#endif // INSTRUMENTATION_H
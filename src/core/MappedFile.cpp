@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+
+MappedFile::MappedFile(const char* path)
+	:
+	fData(NULL),
+	fSize(0),
+	fStatus(B_ENTRY_NOT_FOUND)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		// Only a missing file may be created anew, see HistoryJournal
+		if (errno != ENOENT)
+			fStatus = B_IO_ERROR;
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		fStatus = B_IO_ERROR;
+		close(fd);
+		return;
+	}
+
+	fSize = st.st_size;
+	fStatus = B_OK;
+	if (fSize > 0) {
+		void* data = mmap(NULL, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			fSize = 0;
+			fStatus = B_NO_MEMORY;
+		} else
+			fData = (const char*)data;
+	}
+
+	// The mapping keeps the file alive, even if it gets replaced
+	close(fd);
+}
+
+
+MappedFile::~MappedFile()
+{
+	if (fData != NULL)
+		munmap((void*)fData, fSize);
+}
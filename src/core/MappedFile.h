@@ -0,0 +1,37 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * A read-only memory mapping of a whole file. Clips loaded from the
+ * history journal point into it, so their bytes are only paged in when
+ * they're actually looked at, and the kernel can drop them again.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stddef.h>
+
+#include "CoreDefs.h"
+
+
+class MappedFile {
+public:
+						MappedFile(const char* path);
+						~MappedFile();
+
+	status_t			InitCheck() const { return fStatus; }
+
+	const char*			Data() const { return fData; }
+	size_t				Size() const { return fSize; }
+
+private:
+						MappedFile(const MappedFile&);
+			MappedFile&	operator=(const MappedFile&);
+
+	const char*			fData;
+	size_t				fSize;
+	status_t			fStatus;
+};
+
+#endif // MAPPEDFILE_H
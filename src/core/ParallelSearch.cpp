@@ -0,0 +1,265 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include "ParallelSearch.h"
+#include "Tracing.h"
+
+
+// Items a thread takes at a time. A cancel is looked for at every item,
+// since an item may be a large blob.
+static const int32 kChunkItems = 32;
+// Fewer items aren't worth waking up the other threads for
+static const int32 kMinParallelItems = 2048;
+
+
+struct ParallelSearch::Job {
+	int32				count;
+	int32				chunks;
+	const MatchFunction* match;
+	const CancelFunction* cancelled;
+	std::vector<std::vector<int32> > found;		// Per chunk
+	std::unique_ptr<std::atomic<bool>[]> done;	// Per chunk
+	std::atomic<bool>	stop;
+	int32				collected;	// Chunks appended to the matches
+};
+
+
+static inline uint64
+make_shard(uint32 front, uint32 back)
+{
+	return ((uint64)back << 32) | front;
+}
+
+
+static bool
+take_front(std::atomic<uint64>& shard, int32& chunk)
+{
+	uint64 value = shard.load();
+	while (true) {
+		uint32 front = (uint32)value;
+		uint32 back = (uint32)(value >> 32);
+		if (front >= back)
+			return false;
+		if (shard.compare_exchange_weak(value, make_shard(front + 1, back))) {
+			chunk = front;
+			return true;
+		}
+	}
+}
+
+
+static bool
+take_back(std::atomic<uint64>& shard, int32& chunk)
+{
+	uint64 value = shard.load();
+	while (true) {
+		uint32 front = (uint32)value;
+		uint32 back = (uint32)(value >> 32);
+		if (front >= back)
+			return false;
+		if (shard.compare_exchange_weak(value, make_shard(front, back - 1))) {
+			chunk = back - 1;
+			return true;
+		}
+	}
+}
+
+
+// #pragma mark -
+
+
+ParallelSearch::ParallelSearch(int32 threads)
+	:
+	fJob(NULL),
+	fJobNumber(0),
+	fBusy(0),
+	fQuitting(false)
+{
+	if (threads <= 0)
+		threads = std::max(1, (int32)std::thread::hardware_concurrency());
+
+	std::vector<std::atomic<uint64> >(threads).swap(fShards);
+	for (int32 i = 0; i < threads; i++)
+		fShards[i] = 0;
+
+	for (int32 i = 1; i < threads; i++)
+		fThreads.push_back(std::thread(&ParallelSearch::_Run, this, i));
+}
+
+
+ParallelSearch::~ParallelSearch()
+{
+	{
+		std::lock_guard<std::mutex> lock(fLock);
+		fQuitting = true;
+	}
+	fStart.notify_all();
+	for (size_t i = 0; i < fThreads.size(); i++)
+		fThreads[i].join();
+}
+
+
+bool
+ParallelSearch::Run(int32 count, const MatchFunction& match,
+	const CancelFunction& cancelled, const ProgressFunction& progress,
+	std::vector<int32>& matches)
+{
+	if (count < kMinParallelItems || fThreads.empty())
+		return _RunAlone(count, match, cancelled, progress, matches);
+
+	TRACE_SPAN("ParallelSearch::Run");
+
+	Job job;
+	job.count = count;
+	job.chunks = (count + kChunkItems - 1) / kChunkItems;
+	job.match = &match;
+	job.cancelled = &cancelled;
+	job.found.resize(job.chunks);
+	job.done.reset(new std::atomic<bool>[job.chunks]);
+	for (int32 i = 0; i < job.chunks; i++)
+		job.done[i] = false;
+	job.stop = false;
+	job.collected = 0;
+
+	int32 threads = CountThreads();
+	for (int32 i = 0; i < threads; i++) {
+		fShards[i] = make_shard((int64)job.chunks * i / threads,
+			(int64)job.chunks * (i + 1) / threads);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(fLock);
+		fJob = &job;
+		fJobNumber++;
+		fBusy = (int32)fThreads.size();
+	}
+	fStart.notify_all();
+
+	// This thread works along, and hands out the matches
+	_Work(job, 0, &matches, &progress);
+
+	{
+		std::unique_lock<std::mutex> lock(fLock);
+		while (fBusy > 0)
+			fFinished.wait(lock);
+		fJob = NULL;
+	}
+
+	if (job.stop)
+		return false;
+	_Collect(job, matches);
+	return true;
+}
+
+
+bool
+ParallelSearch::_RunAlone(int32 count, const MatchFunction& match,
+	const CancelFunction& cancelled, const ProgressFunction& progress,
+	std::vector<int32>& matches)
+{
+	for (int32 first = 0; first < count; first += kChunkItems) {
+		size_t before = matches.size();
+		int32 end = std::min(count, first + kChunkItems);
+		for (int32 i = first; i < end; i++) {
+			if (cancelled && cancelled())
+				return false;
+
+			int32 index = match(i);
+			if (index >= 0)
+				matches.push_back(index);
+		}
+		if (matches.size() != before && progress)
+			progress();
+	}
+	return true;
+}
+
+
+void
+ParallelSearch::_Run(int32 thread)
+{
+	TRACE_THREAD("parallel search");
+
+	std::unique_lock<std::mutex> lock(fLock);
+	uint32 jobNumber = 0;
+	while (true) {
+		if (fQuitting)
+			break;
+		if (fJobNumber == jobNumber) {
+			fStart.wait(lock);
+			continue;
+		}
+
+		jobNumber = fJobNumber;
+		Job* job = fJob;
+		lock.unlock();
+		_Work(*job, thread, NULL, NULL);
+		lock.lock();
+
+		if (--fBusy == 0)
+			fFinished.notify_all();
+	}
+}
+
+
+void
+ParallelSearch::_Work(Job& job, int32 thread, std::vector<int32>* matches,
+	const ProgressFunction* progress)
+{
+	int32 chunk;
+	while (!job.stop && _NextChunk(thread, chunk)) {
+		std::vector<int32>& found = job.found[chunk];
+		int32 first = chunk * kChunkItems;
+		int32 end = std::min(job.count, first + kChunkItems);
+		for (int32 i = first; i < end; i++) {
+			if (job.stop || (*job.cancelled && (*job.cancelled)())) {
+				// The chunk stays unfinished, nothing is collected anymore
+				job.stop = true;
+				return;
+			}
+
+			int32 index = (*job.match)(i);
+			if (index >= 0)
+				found.push_back(index);
+		}
+		job.done[chunk].store(true, std::memory_order_release);
+
+		if (matches != NULL && _Collect(job, *matches) && *progress)
+			(*progress)();
+	}
+}
+
+
+bool
+ParallelSearch::_NextChunk(int32 thread, int32& chunk)
+{
+	if (take_front(fShards[thread], chunk))
+		return true;
+
+	int32 threads = CountThreads();
+	for (int32 i = 1; i < threads; i++) {
+		if (take_back(fShards[(thread + i) % threads], chunk))
+			return true;
+	}
+	return false;
+}
+
+
+bool
+ParallelSearch::_Collect(Job& job, std::vector<int32>& matches)
+{
+	// Only the chunks before the first unfinished one, to keep the order
+	size_t before = matches.size();
+	while (job.collected < job.chunks
+		&& job.done[job.collected].load(std::memory_order_acquire)) {
+		std::vector<int32>& found = job.found[job.collected];
+		matches.insert(matches.end(), found.begin(), found.end());
+		job.collected++;
+	}
+	return matches.size() != before;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Checks a long list of items on all cores. The items are cut into
+ * chunks, and each thread gets a shard of them. A thread takes its own
+ * chunks from the front and, once it's out of them, steals from the back
+ * of the other shards, so one with large clips doesn't leave the others
+ * idle. The matches of each chunk are kept apart and joined in chunk
+ * order, so they stay in item order. For the history, that's recency.
+ *
+ * Short lists are checked by the calling thread alone.
+ */
+
+#ifndef PARALLELSEARCH_H
+#define PARALLELSEARCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "CoreDefs.h"
+
+
+class ParallelSearch {
+public:
+	// Returns the index to report for item 'item', or -1 if it doesn't
+	// match. Called from all threads at once.
+	typedef std::function<int32(int32 item)> MatchFunction;
+	// Asked before every item, from all threads
+	typedef std::function<bool()> CancelFunction;
+	// Called from the thread that called Run(), after more matches were
+	// appended
+	typedef std::function<void()> ProgressFunction;
+
+						// One thread per core if 'threads' is 0. The
+						// calling thread is one of them.
+						ParallelSearch(int32 threads = 0);
+						~ParallelSearch();
+
+	int32				CountThreads() const
+							{ return (int32)fThreads.size() + 1; }
+
+	// Checks the items 0 to count - 1, and appends the indexes 'match'
+	// returns for them to 'matches', in item order. Returns false if it
+	// got cancelled, 'matches' is incomplete then.
+	bool				Run(int32 count, const MatchFunction& match,
+							const CancelFunction& cancelled,
+							const ProgressFunction& progress,
+							std::vector<int32>& matches);
+
+private:
+	struct Job;
+
+	bool				_RunAlone(int32 count, const MatchFunction& match,
+							const CancelFunction& cancelled,
+							const ProgressFunction& progress,
+							std::vector<int32>& matches);
+	void				_Run(int32 thread);
+	void				_Work(Job& job, int32 thread,
+							std::vector<int32>* matches,
+							const ProgressFunction* progress);
+	bool				_NextChunk(int32 thread, int32& chunk);
+	bool				_Collect(Job& job, std::vector<int32>& matches);
+
+	std::vector<std::thread> fThreads;
+	// Per thread, the chunks that are left: front and back end
+	std::vector<std::atomic<uint64> > fShards;
+
+	std::mutex			fLock;
+	std::condition_variable fStart;
+	std::condition_variable fFinished;
+	Job*				fJob;
+	uint32				fJobNumber;
+	int32				fBusy;			// helper threads
+	bool				fQuitting;
+};
+
+#endif // PARALLELSEARCH_H
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ClipHash.h"
+#include "Instrumentation.h"
+#include "RecordFile.h"
+
+
+static const uint32 kRecordMarker = 'CDRC';
+
+struct record_header {
+	uint32	marker;
+	uint32	type;
+	uint32	size;
+	uint32	checksum;
+};
+
+
+static uint32
+record_checksum(const record_header& header, const char* payload)
+{
+	uint32 fields[2] = { header.type, header.size };
+	uint64 hash = hash_clip(fields, sizeof(fields));
+	if ((header.type & kUncheckedPayload) == 0)
+		hash ^= hash_clip(payload, header.size) * 31;
+	return (uint32)(hash ^ (hash >> 32));
+}
+
+
+RecordWriter::RecordWriter(std::string& buffer)
+	:
+	fBuffer(buffer),
+	fStart(0)
+{
+}
+
+
+void
+RecordWriter::StartRecord(uint32 type)
+{
+	fStart = fBuffer.length();
+
+	record_header header = { kRecordMarker, type, 0, 0 };
+	fBuffer.append((const char*)&header, sizeof(header));
+}
+
+
+void
+RecordWriter::EndRecord()
+{
+	record_header header;
+	memcpy(&header, &fBuffer[fStart], sizeof(header));
+	header.size = fBuffer.length() - fStart - sizeof(header);
+	header.checksum = record_checksum(header,
+		fBuffer.data() + fStart + sizeof(header));
+	memcpy(&fBuffer[fStart], &header, sizeof(header));
+}
+
+
+void
+RecordWriter::PutUInt32(uint32 value)
+{
+	fBuffer.append((const char*)&value, sizeof(value));
+}
+
+
+void
+RecordWriter::PutUInt64(uint64 value)
+{
+	fBuffer.append((const char*)&value, sizeof(value));
+}
+
+
+void
+RecordWriter::PutString(const char* data, size_t length)
+{
+	PutUInt32(length);
+	fBuffer.append(data, length);
+	INSTRUMENT_COPY(length);
+}
+
+
+void
+RecordWriter::PutRaw(const char* data, size_t length)
+{
+	fBuffer.append(data, length);
+	INSTRUMENT_COPY(length);
+}
+
+
+// #pragma mark - RecordReader
+
+
+RecordReader::RecordReader(const char* data, size_t length)
+	:
+	fData(data),
+	fEnd(data + length)
+{
+}
+
+
+bool
+RecordReader::GetUInt32(uint32& value)
+{
+	return _Get(&value, sizeof(value));
+}
+
+
+bool
+RecordReader::GetUInt64(uint64& value)
+{
+	return _Get(&value, sizeof(value));
+}
+
+
+bool
+RecordReader::GetString(const char*& data, uint32& length)
+{
+	if (!GetUInt32(length) || (size_t)(fEnd - fData) < length)
+		return false;
+
+	data = fData;
+	fData += length;
+	return true;
+}
+
+
+bool
+RecordReader::GetString(std::string& string)
+{
+	const char* data;
+	uint32 length;
+	if (!GetString(data, length))
+		return false;
+
+	string.assign(data, length);
+	return true;
+}
+
+
+bool
+RecordReader::_Get(void* value, size_t size)
+{
+	if ((size_t)(fEnd - fData) < size)
+		return false;
+
+	memcpy(value, fData, size);
+	fData += size;
+	return true;
+}
+
+
+// #pragma mark - RecordScanner
+
+
+RecordScanner::RecordScanner(const char* data, size_t size)
+	:
+	fData(data),
+	fSize(size),
+	fOffset(0),
+	fEnd(0),
+	fDamaged(0)
+{
+}
+
+
+bool
+RecordScanner::Next(uint32& type, const char*& payload, uint32& size)
+{
+	if (fOffset < fSize && !_IsRecord(fOffset)) {
+		// Look for the next marker that starts an intact record
+		const char marker[4] = { (char)(kRecordMarker & 0xff),
+			(char)((kRecordMarker >> 8) & 0xff),
+			(char)((kRecordMarker >> 16) & 0xff),
+			(char)(kRecordMarker >> 24) };
+		size_t offset = fOffset + 1;
+		while (offset < fSize) {
+			const char* found = (const char*)memchr(fData + offset, marker[0],
+				fSize - offset);
+			if (found == NULL) {
+				offset = fSize;
+				break;
+			}
+			offset = found - fData;
+			if (fSize - offset >= sizeof(marker)
+				&& memcmp(found, marker, sizeof(marker)) == 0
+				&& _IsRecord(offset))
+				break;
+			offset++;
+		}
+
+		fOffset = offset;
+		if (fOffset < fSize)
+			fDamaged++;
+	}
+
+	if (fOffset >= fSize)
+		return false;
+
+	record_header header;
+	memcpy(&header, fData + fOffset, sizeof(header));
+	type = header.type;
+	payload = fData + fOffset + sizeof(header);
+	size = header.size;
+
+	fOffset += sizeof(header) + header.size;
+	fEnd = fOffset;
+	return true;
+}
+
+
+bool
+RecordScanner::_IsRecord(size_t offset) const
+{
+	record_header header;
+	if (fSize - offset < sizeof(header))
+		return false;
+
+	memcpy(&header, fData + offset, sizeof(header));
+	return header.marker == kRecordMarker
+		&& fSize - offset - sizeof(header) >= header.size
+		&& header.checksum
+			== record_checksum(header, fData + offset + sizeof(header));
+}
+
+
+// #pragma mark -
+
+
+static status_t
+write_and_sync(const char* path, const char* mode, const char* data,
+	size_t length)
+{
+	FILE* file = fopen(path, mode);
+	if (file == NULL)
+		return B_IO_ERROR;
+
+	bool ok = fwrite(data, 1, length, file) == length
+		&& fflush(file) == 0 && fsync(fileno(file)) == 0;
+	if (fclose(file) != 0)
+		ok = false;
+	return ok ? B_OK : B_IO_ERROR;
+}
+
+
+status_t
+write_file_atomically(const char* path, const char* data, size_t length)
+{
+	std::string tempPath(path);
+	tempPath += ".new";
+
+	status_t status = write_and_sync(tempPath.c_str(), "wb", data, length);
+	if (status == B_OK && rename(tempPath.c_str(), path) != 0)
+		status = B_IO_ERROR;
+	if (status != B_OK) {
+		remove(tempPath.c_str());
+		return status;
+	}
+
+	// Make the rename itself durable
+	std::string directory(path);
+	size_t slash = directory.rfind('/');
+	directory = slash == std::string::npos ? "." : directory.substr(0, slash + 1);
+	int fd = open(directory.c_str(), O_RDONLY);
+	if (fd >= 0) {
+		fsync(fd);
+		close(fd);
+	}
+	return B_OK;
+}
+
+
+status_t
+append_to_file(const char* path, const char* data, size_t length)
+{
+	return write_and_sync(path, "ab", data, length);
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * The persistence layer shared by the history journal, the favorites and
+ * the settings. Files are sequences of records, each with a marker, its
+ * type, its size and a checksum, so a damaged record can be skipped and
+ * everything intact around it salvaged. Whole files are only ever
+ * replaced atomically.
+ */
+
+#ifndef RECORDFILE_H
+#define RECORDFILE_H
+
+#include <stddef.h>
+
+#include <string>
+
+#include "CoreDefs.h"
+
+
+// The payload of records with this type flag isn't checksummed, e.g.
+// because it's too big to verify when loading. Only their header is.
+static const uint32 kUncheckedPayload = 0x80000000;
+
+
+// Appends records to a buffer
+class RecordWriter {
+public:
+						RecordWriter(std::string& buffer);
+
+	void				StartRecord(uint32 type);
+	void				EndRecord();
+
+	void				PutUInt32(uint32 value);
+	void				PutUInt64(uint64 value);
+	// Length prefixed
+	void				PutString(const char* data, size_t length);
+	void				PutString(const std::string& string)
+							{ PutString(string.data(), string.length()); }
+	void				PutRaw(const char* data, size_t length);
+
+	// Offset in the buffer where the next byte goes
+	size_t				Position() const { return fBuffer.length(); }
+
+private:
+	std::string&		fBuffer;
+	size_t				fStart;
+};
+
+
+// Reads the payload of a record
+class RecordReader {
+public:
+						RecordReader(const char* data, size_t length);
+
+	bool				GetUInt32(uint32& value);
+	bool				GetUInt64(uint64& value);
+	// Doesn't copy the bytes, they stay where they are
+	bool				GetString(const char*& data, uint32& length);
+	bool				GetString(std::string& string);
+
+private:
+	bool				_Get(void* value, size_t size);
+
+	const char*			fData;
+	const char*			fEnd;
+};
+
+
+// Iterates over the intact records of a file's contents
+class RecordScanner {
+public:
+						RecordScanner(const char* data, size_t size);
+
+	// Skips damaged records by looking for the next intact one
+	bool				Next(uint32& type, const char*& payload,
+							uint32& size);
+
+	// The end of the last intact record. Anything after it is damaged,
+	// e.g. torn by a crash while appending.
+	size_t				End() const { return fEnd; }
+	// Damaged stretches with intact records after them
+	int32				CountDamaged() const { return fDamaged; }
+
+private:
+	bool				_IsRecord(size_t offset) const;
+
+	const char*			fData;
+	size_t				fSize;
+	size_t				fOffset;
+	size_t				fEnd;
+	int32				fDamaged;
+};
+
+
+// Writes the file through a temporary one that's synced and then renamed
+// over it, so that there's always a complete version.
+status_t	write_file_atomically(const char* path, const char* data,
+				size_t length);
+status_t	append_to_file(const char* path, const char* data, size_t length);
+
+#endif // RECORDFILE_H
@@ -0,0 +1,661 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <string.h>
+
+#include <mutex>
+
+#include "TextSearch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#	include <immintrin.h>
+#	define SEARCH_X86 1
+#endif
+
+
+struct fold_range {
+	uint32	first;
+	uint32	last;
+	int32	delta;
+	uint32	stride;		// 2 when upper and lower case alternate
+};
+
+// Unicode 14.0 simple case folding (CaseFolding.txt, status C and S),
+// without ASCII.
+static const fold_range kFoldRanges[] = {
+	{ 0x00B5, 0x00B5, 775, 1 },
+	{ 0x00C0, 0x00D6, 32, 1 },
+	{ 0x00D8, 0x00DE, 32, 1 },
+	{ 0x0100, 0x012E, 1, 2 },
+	{ 0x0132, 0x0136, 1, 2 },
+	{ 0x0139, 0x0147, 1, 2 },
+	{ 0x014A, 0x0176, 1, 2 },
+	{ 0x0178, 0x0178, -121, 1 },
+	{ 0x0179, 0x017D, 1, 2 },
+	{ 0x017F, 0x017F, -268, 1 },
+	{ 0x0181, 0x0181, 210, 1 },
+	{ 0x0182, 0x0184, 1, 2 },
+	{ 0x0186, 0x0186, 206, 1 },
+	{ 0x0187, 0x0187, 1, 1 },
+	{ 0x0189, 0x018A, 205, 1 },
+	{ 0x018B, 0x018B, 1, 1 },
+	{ 0x018E, 0x018E, 79, 1 },
+	{ 0x018F, 0x018F, 202, 1 },
+	{ 0x0190, 0x0190, 203, 1 },
+	{ 0x0191, 0x0191, 1, 1 },
+	{ 0x0193, 0x0193, 205, 1 },
+	{ 0x0194, 0x0194, 207, 1 },
+	{ 0x0196, 0x0196, 211, 1 },
+	{ 0x0197, 0x0197, 209, 1 },
+	{ 0x0198, 0x0198, 1, 1 },
+	{ 0x019C, 0x019C, 211, 1 },
+	{ 0x019D, 0x019D, 213, 1 },
+	{ 0x019F, 0x019F, 214, 1 },
+	{ 0x01A0, 0x01A4, 1, 2 },
+	{ 0x01A6, 0x01A6, 218, 1 },
+	{ 0x01A7, 0x01A7, 1, 1 },
+	{ 0x01A9, 0x01A9, 218, 1 },
+	{ 0x01AC, 0x01AC, 1, 1 },
+	{ 0x01AE, 0x01AE, 218, 1 },
+	{ 0x01AF, 0x01AF, 1, 1 },
+	{ 0x01B1, 0x01B2, 217, 1 },
+	{ 0x01B3, 0x01B5, 1, 2 },
+	{ 0x01B7, 0x01B7, 219, 1 },
+	{ 0x01B8, 0x01B8, 1, 1 },
+	{ 0x01BC, 0x01BC, 1, 1 },
+	{ 0x01C4, 0x01C4, 2, 1 },
+	{ 0x01C5, 0x01C5, 1, 1 },
+	{ 0x01C7, 0x01C7, 2, 1 },
+	{ 0x01C8, 0x01C8, 1, 1 },
+	{ 0x01CA, 0x01CA, 2, 1 },
+	{ 0x01CB, 0x01DB, 1, 2 },
+	{ 0x01DE, 0x01EE, 1, 2 },
+	{ 0x01F1, 0x01F1, 2, 1 },
+	{ 0x01F2, 0x01F4, 1, 2 },
+	{ 0x01F6, 0x01F6, -97, 1 },
+	{ 0x01F7, 0x01F7, -56, 1 },
+	{ 0x01F8, 0x021E, 1, 2 },
+	{ 0x0220, 0x0220, -130, 1 },
+	{ 0x0222, 0x0232, 1, 2 },
+	{ 0x023A, 0x023A, 10795, 1 },
+	{ 0x023B, 0x023B, 1, 1 },
+	{ 0x023D, 0x023D, -163, 1 },
+	{ 0x023E, 0x023E, 10792, 1 },
+	{ 0x0241, 0x0241, 1, 1 },
+	{ 0x0243, 0x0243, -195, 1 },
+	{ 0x0244, 0x0244, 69, 1 },
+	{ 0x0245, 0x0245, 71, 1 },
+	{ 0x0246, 0x024E, 1, 2 },
+	{ 0x0345, 0x0345, 116, 1 },
+	{ 0x0370, 0x0372, 1, 2 },
+	{ 0x0376, 0x0376, 1, 1 },
+	{ 0x037F, 0x037F, 116, 1 },
+	{ 0x0386, 0x0386, 38, 1 },
+	{ 0x0388, 0x038A, 37, 1 },
+	{ 0x038C, 0x038C, 64, 1 },
+	{ 0x038E, 0x038F, 63, 1 },
+	{ 0x0391, 0x03A1, 32, 1 },
+	{ 0x03A3, 0x03AB, 32, 1 },
+	{ 0x03C2, 0x03C2, 1, 1 },
+	{ 0x03CF, 0x03CF, 8, 1 },
+	{ 0x03D0, 0x03D0, -30, 1 },
+	{ 0x03D1, 0x03D1, -25, 1 },
+	{ 0x03D5, 0x03D5, -15, 1 },
+	{ 0x03D6, 0x03D6, -22, 1 },
+	{ 0x03D8, 0x03EE, 1, 2 },
+	{ 0x03F0, 0x03F0, -54, 1 },
+	{ 0x03F1, 0x03F1, -48, 1 },
+	{ 0x03F4, 0x03F4, -60, 1 },
+	{ 0x03F5, 0x03F5, -64, 1 },
+	{ 0x03F7, 0x03F7, 1, 1 },
+	{ 0x03F9, 0x03F9, -7, 1 },
+	{ 0x03FA, 0x03FA, 1, 1 },
+	{ 0x03FD, 0x03FF, -130, 1 },
+	{ 0x0400, 0x040F, 80, 1 },
+	{ 0x0410, 0x042F, 32, 1 },
+	{ 0x0460, 0x0480, 1, 2 },
+	{ 0x048A, 0x04BE, 1, 2 },
+	{ 0x04C0, 0x04C0, 15, 1 },
+	{ 0x04C1, 0x04CD, 1, 2 },
+	{ 0x04D0, 0x052E, 1, 2 },
+	{ 0x0531, 0x0556, 48, 1 },
+	{ 0x10A0, 0x10C5, 7264, 1 },
+	{ 0x10C7, 0x10C7, 7264, 1 },
+	{ 0x10CD, 0x10CD, 7264, 1 },
+	{ 0x13A0, 0x13EF, 38864, 1 },
+	{ 0x13F0, 0x13F5, 8, 1 },
+	{ 0x13F8, 0x13FD, -8, 1 },
+	{ 0x1C80, 0x1C80, -6222, 1 },
+	{ 0x1C81, 0x1C81, -6221, 1 },
+	{ 0x1C82, 0x1C82, -6212, 1 },
+	{ 0x1C83, 0x1C84, -6210, 1 },
+	{ 0x1C85, 0x1C85, -6211, 1 },
+	{ 0x1C86, 0x1C86, -6204, 1 },
+	{ 0x1C87, 0x1C87, -6180, 1 },
+	{ 0x1C88, 0x1C88, 35267, 1 },
+	{ 0x1C90, 0x1CBA, -3008, 1 },
+	{ 0x1CBD, 0x1CBF, -3008, 1 },
+	{ 0x1E00, 0x1E94, 1, 2 },
+	{ 0x1E9B, 0x1E9B, -58, 1 },
+	{ 0x1E9E, 0x1E9E, -7615, 1 },
+	{ 0x1EA0, 0x1EFE, 1, 2 },
+	{ 0x1F08, 0x1F0F, -8, 1 },
+	{ 0x1F18, 0x1F1D, -8, 1 },
+	{ 0x1F28, 0x1F2F, -8, 1 },
+	{ 0x1F38, 0x1F3F, -8, 1 },
+	{ 0x1F48, 0x1F4D, -8, 1 },
+	{ 0x1F59, 0x1F5F, -8, 2 },
+	{ 0x1F68, 0x1F6F, -8, 1 },
+	{ 0x1F88, 0x1F8F, -8, 1 },
+	{ 0x1F98, 0x1F9F, -8, 1 },
+	{ 0x1FA8, 0x1FAF, -8, 1 },
+	{ 0x1FB8, 0x1FB9, -8, 1 },
+	{ 0x1FBA, 0x1FBB, -74, 1 },
+	{ 0x1FBC, 0x1FBC, -9, 1 },
+	{ 0x1FBE, 0x1FBE, -7173, 1 },
+	{ 0x1FC8, 0x1FCB, -86, 1 },
+	{ 0x1FCC, 0x1FCC, -9, 1 },
+	{ 0x1FD8, 0x1FD9, -8, 1 },
+	{ 0x1FDA, 0x1FDB, -100, 1 },
+	{ 0x1FE8, 0x1FE9, -8, 1 },
+	{ 0x1FEA, 0x1FEB, -112, 1 },
+	{ 0x1FEC, 0x1FEC, -7, 1 },
+	{ 0x1FF8, 0x1FF9, -128, 1 },
+	{ 0x1FFA, 0x1FFB, -126, 1 },
+	{ 0x1FFC, 0x1FFC, -9, 1 },
+	{ 0x2126, 0x2126, -7517, 1 },
+	{ 0x212A, 0x212A, -8383, 1 },
+	{ 0x212B, 0x212B, -8262, 1 },
+	{ 0x2132, 0x2132, 28, 1 },
+	{ 0x2160, 0x216F, 16, 1 },
+	{ 0x2183, 0x2183, 1, 1 },
+	{ 0x24B6, 0x24CF, 26, 1 },
+	{ 0x2C00, 0x2C2F, 48, 1 },
+	{ 0x2C60, 0x2C60, 1, 1 },
+	{ 0x2C62, 0x2C62, -10743, 1 },
+	{ 0x2C63, 0x2C63, -3814, 1 },
+	{ 0x2C64, 0x2C64, -10727, 1 },
+	{ 0x2C67, 0x2C6B, 1, 2 },
+	{ 0x2C6D, 0x2C6D, -10780, 1 },
+	{ 0x2C6E, 0x2C6E, -10749, 1 },
+	{ 0x2C6F, 0x2C6F, -10783, 1 },
+	{ 0x2C70, 0x2C70, -10782, 1 },
+	{ 0x2C72, 0x2C72, 1, 1 },
+	{ 0x2C75, 0x2C75, 1, 1 },
+	{ 0x2C7E, 0x2C7F, -10815, 1 },
+	{ 0x2C80, 0x2CE2, 1, 2 },
+	{ 0x2CEB, 0x2CED, 1, 2 },
+	{ 0x2CF2, 0x2CF2, 1, 1 },
+	{ 0xA640, 0xA66C, 1, 2 },
+	{ 0xA680, 0xA69A, 1, 2 },
+	{ 0xA722, 0xA72E, 1, 2 },
+	{ 0xA732, 0xA76E, 1, 2 },
+	{ 0xA779, 0xA77B, 1, 2 },
+	{ 0xA77D, 0xA77D, -35332, 1 },
+	{ 0xA77E, 0xA786, 1, 2 },
+	{ 0xA78B, 0xA78B, 1, 1 },
+	{ 0xA78D, 0xA78D, -42280, 1 },
+	{ 0xA790, 0xA792, 1, 2 },
+	{ 0xA796, 0xA7A8, 1, 2 },
+	{ 0xA7AA, 0xA7AA, -42308, 1 },
+	{ 0xA7AB, 0xA7AB, -42319, 1 },
+	{ 0xA7AC, 0xA7AC, -42315, 1 },
+	{ 0xA7AD, 0xA7AD, -42305, 1 },
+	{ 0xA7AE, 0xA7AE, -42308, 1 },
+	{ 0xA7B0, 0xA7B0, -42258, 1 },
+	{ 0xA7B1, 0xA7B1, -42282, 1 },
+	{ 0xA7B2, 0xA7B2, -42261, 1 },
+	{ 0xA7B3, 0xA7B3, 928, 1 },
+	{ 0xA7B4, 0xA7C2, 1, 2 },
+	{ 0xA7C4, 0xA7C4, -48, 1 },
+	{ 0xA7C5, 0xA7C5, -42307, 1 },
+	{ 0xA7C6, 0xA7C6, -35384, 1 },
+	{ 0xA7C7, 0xA7C9, 1, 2 },
+	{ 0xA7D0, 0xA7D0, 1, 1 },
+	{ 0xA7D6, 0xA7D8, 1, 2 },
+	{ 0xA7F5, 0xA7F5, 1, 1 },
+	{ 0xAB70, 0xABBF, -38864, 1 },
+	{ 0xFF21, 0xFF3A, 32, 1 },
+	{ 0x10400, 0x10427, 40, 1 },
+	{ 0x104B0, 0x104D3, 40, 1 },
+	{ 0x10570, 0x1057A, 39, 1 },
+	{ 0x1057C, 0x1058A, 39, 1 },
+	{ 0x1058C, 0x10592, 39, 1 },
+	{ 0x10594, 0x10595, 39, 1 },
+	{ 0x10C80, 0x10CB2, 64, 1 },
+	{ 0x118A0, 0x118BF, 32, 1 },
+	{ 0x16E40, 0x16E5F, 32, 1 },
+	{ 0x1E900, 0x1E921, 34, 1 },
+};
+
+static const size_t kFoldRangeCount = sizeof(kFoldRanges) / sizeof(kFoldRanges[0]);
+
+
+uint32
+fold_char(uint32 c)
+{
+	if (c < 0x80)
+		return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+
+	size_t low = 0;
+	size_t high = kFoldRangeCount;
+	while (low < high) {
+		size_t middle = (low + high) / 2;
+		if (kFoldRanges[middle].last < c)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if (low < kFoldRangeCount && kFoldRanges[low].first <= c
+		&& (c - kFoldRanges[low].first) % kFoldRanges[low].stride == 0)
+		return c + kFoldRanges[low].delta;
+
+	return c;
+}
+
+
+static inline void
+encode_char(uint32 c, std::string& text)
+{
+	if ((c & kInvalidByte) != 0)
+		text += (char)(c & 0xff);
+	else if (c < 0x80)
+		text += (char)c;
+	else if (c < 0x800) {
+		text += (char)(0xc0 | (c >> 6));
+		text += (char)(0x80 | (c & 0x3f));
+	} else if (c < 0x10000) {
+		text += (char)(0xe0 | (c >> 12));
+		text += (char)(0x80 | ((c >> 6) & 0x3f));
+		text += (char)(0x80 | (c & 0x3f));
+	} else {
+		text += (char)(0xf0 | (c >> 18));
+		text += (char)(0x80 | ((c >> 12) & 0x3f));
+		text += (char)(0x80 | ((c >> 6) & 0x3f));
+		text += (char)(0x80 | (c & 0x3f));
+	}
+}
+
+
+static inline uint8
+lead_byte(uint32 c)
+{
+	std::string encoded;
+	encode_char(c, encoded);
+	return encoded[0];
+}
+
+
+void
+fold_text(const char* text, size_t length, std::string& folded)
+{
+	folded.clear();
+	folded.reserve(length);
+
+	const uint8* bytes = (const uint8*)text;
+	const uint8* end = bytes + length;
+	while (bytes < end) {
+		if (*bytes < 0x80) {
+			uint8 c = *bytes++;
+			folded += (char)((c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c);
+		} else
+			encode_char(fold_char(read_char(bytes, end)), folded);
+	}
+}
+
+
+// All characters that fold to the (folded) character c
+static void
+case_variants(uint32 c, std::vector<uint32>& variants)
+{
+	variants.clear();
+	variants.push_back(c);
+	if ((c & kInvalidByte) != 0)
+		return;
+
+	if (c >= 'a' && c <= 'z')
+		variants.push_back(c - ('a' - 'A'));
+	for (size_t i = 0; i < kFoldRangeCount; i++) {
+		const fold_range& range = kFoldRanges[i];
+		int64 source = (int64)c - range.delta;
+		if (source >= range.first && source <= range.last
+			&& (source - range.first) % range.stride == 0)
+			variants.push_back(source);
+	}
+}
+
+
+// #pragma mark - Search kernels
+
+
+struct search_pattern {
+	const uint32*	needle;
+	size_t			needleLength;
+	const uint8*	anchors;
+	int32			anchorCount;
+	// Possible second bytes, if the first character is always one byte
+	const uint8*	seconds;
+	int32			secondCount;
+};
+
+
+static inline bool
+verify_at(const search_pattern& pattern, const uint8* text, const uint8* end)
+{
+	for (size_t i = 0; i < pattern.needleLength; i++) {
+		if (text >= end)
+			return false;
+		uint32 c = *text;
+		if (c < 0x80) {
+			text++;
+			if (c >= 'A' && c <= 'Z')
+				c += 'a' - 'A';
+		} else
+			c = fold_char(read_char(text, end));
+		if (c != pattern.needle[i])
+			return false;
+	}
+	return true;
+}
+
+
+static inline bool
+is_anchor(const search_pattern& pattern, uint8 byte)
+{
+	for (int32 i = 0; i < pattern.anchorCount; i++) {
+		if (pattern.anchors[i] == byte)
+			return true;
+	}
+	return false;
+}
+
+
+static bool
+scan_scalar(const search_pattern& pattern, const uint8* text, size_t length,
+	size_t start)
+{
+	const uint8* end = text + length;
+
+	if (pattern.anchorCount == 0) {
+		// Too many variants for the first character: try every character
+		for (const uint8* position = text + start; position < end; position++) {
+			if ((*position & 0xc0) != 0x80 && verify_at(pattern, position, end))
+				return true;
+		}
+		return false;
+	}
+
+	if (pattern.anchorCount == 1) {
+		const uint8* position = text + start;
+		while (position < end) {
+			position = (const uint8*)memchr(position, pattern.anchors[0],
+				end - position);
+			if (position == NULL)
+				return false;
+			if (verify_at(pattern, position, end))
+				return true;
+			position++;
+		}
+		return false;
+	}
+
+	for (const uint8* position = text + start; position < end; position++) {
+		if (is_anchor(pattern, *position) && verify_at(pattern, position, end))
+			return true;
+	}
+	return false;
+}
+
+
+#if defined(SEARCH_X86) && defined(__SSE2__)
+
+static bool
+scan_sse2(const search_pattern& pattern, const uint8* text, size_t length,
+	size_t start)
+{
+	if (pattern.anchorCount == 0)
+		return scan_scalar(pattern, text, length, start);
+
+	const uint8* end = text + length;
+	__m128i anchors[4];
+	__m128i seconds[2];
+	for (int32 i = 0; i < pattern.anchorCount; i++)
+		anchors[i] = _mm_set1_epi8(pattern.anchors[i]);
+	for (int32 i = 0; i < pattern.secondCount; i++)
+		seconds[i] = _mm_set1_epi8(pattern.seconds[i]);
+
+	// With a second byte we load 17 bytes per block
+	size_t overlap = pattern.secondCount > 0 ? 1 : 0;
+	size_t i = start;
+	for (; i + 16 + overlap <= length; i += 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+		__m128i hits = _mm_cmpeq_epi8(block, anchors[0]);
+		for (int32 j = 1; j < pattern.anchorCount; j++)
+			hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, anchors[j]));
+
+		if (pattern.secondCount > 0) {
+			__m128i next = _mm_loadu_si128((const __m128i*)(text + i + 1));
+			__m128i secondHits = _mm_cmpeq_epi8(next, seconds[0]);
+			if (pattern.secondCount > 1)
+				secondHits = _mm_or_si128(secondHits, _mm_cmpeq_epi8(next, seconds[1]));
+			hits = _mm_and_si128(hits, secondHits);
+		}
+
+		uint32 mask = _mm_movemask_epi8(hits);
+		while (mask != 0) {
+			if (verify_at(pattern, text + i + __builtin_ctz(mask), end))
+				return true;
+			mask &= mask - 1;
+		}
+	}
+	return scan_scalar(pattern, text, length, i);
+}
+
+#endif // SEARCH_X86 && __SSE2__
+
+
+#ifdef SEARCH_X86
+
+__attribute__((target("avx2")))
+static bool
+scan_avx2(const search_pattern& pattern, const uint8* text, size_t length,
+	size_t start)
+{
+	if (pattern.anchorCount == 0)
+		return scan_scalar(pattern, text, length, start);
+
+	const uint8* end = text + length;
+	__m256i anchors[4];
+	__m256i seconds[2];
+	for (int32 i = 0; i < pattern.anchorCount; i++)
+		anchors[i] = _mm256_set1_epi8(pattern.anchors[i]);
+	for (int32 i = 0; i < pattern.secondCount; i++)
+		seconds[i] = _mm256_set1_epi8(pattern.seconds[i]);
+
+	size_t overlap = pattern.secondCount > 0 ? 1 : 0;
+	size_t i = start;
+	for (; i + 32 + overlap <= length; i += 32) {
+		__m256i block = _mm256_loadu_si256((const __m256i*)(text + i));
+		__m256i hits = _mm256_cmpeq_epi8(block, anchors[0]);
+		for (int32 j = 1; j < pattern.anchorCount; j++)
+			hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, anchors[j]));
+
+		if (pattern.secondCount > 0) {
+			__m256i next = _mm256_loadu_si256((const __m256i*)(text + i + 1));
+			__m256i secondHits = _mm256_cmpeq_epi8(next, seconds[0]);
+			if (pattern.secondCount > 1) {
+				secondHits = _mm256_or_si256(secondHits,
+					_mm256_cmpeq_epi8(next, seconds[1]));
+			}
+			hits = _mm256_and_si256(hits, secondHits);
+		}
+
+		uint32 mask = _mm256_movemask_epi8(hits);
+		while (mask != 0) {
+			if (verify_at(pattern, text + i + __builtin_ctz(mask), end))
+				return true;
+			mask &= mask - 1;
+		}
+	}
+	return scan_scalar(pattern, text, length, i);
+}
+
+#endif // SEARCH_X86
+
+
+typedef bool (*scan_function)(const search_pattern& pattern, const uint8* text,
+	size_t length, size_t start);
+
+static scan_function sScan = NULL;
+static const char* sScanName = NULL;
+static std::once_flag sScanChosen;
+
+
+static void
+choose_search_kernel()
+{
+	if (sScan == NULL)
+		set_search_kernel(SEARCH_KERNEL_AUTO);
+}
+
+
+bool
+set_search_kernel(int32 kernel)
+{
+	switch (kernel) {
+		case SEARCH_KERNEL_AUTO:
+#ifdef SEARCH_X86
+			if (__builtin_cpu_supports("avx2"))
+				return set_search_kernel(SEARCH_KERNEL_AVX2);
+#endif
+#if defined(SEARCH_X86) && defined(__SSE2__)
+			return set_search_kernel(SEARCH_KERNEL_SSE2);
+#else
+			return set_search_kernel(SEARCH_KERNEL_SCALAR);
+#endif
+
+		case SEARCH_KERNEL_SCALAR:
+			sScan = scan_scalar;
+			sScanName = "scalar";
+			return true;
+
+#if defined(SEARCH_X86) && defined(__SSE2__)
+		case SEARCH_KERNEL_SSE2:
+			sScan = scan_sse2;
+			sScanName = "sse2";
+			return true;
+#endif
+
+#ifdef SEARCH_X86
+		case SEARCH_KERNEL_AVX2:
+			if (!__builtin_cpu_supports("avx2"))
+				return false;
+			sScan = scan_avx2;
+			sScanName = "avx2";
+			return true;
+#endif
+
+		default:
+			return false;
+	}
+}
+
+
+const char*
+search_kernel_name()
+{
+	std::call_once(sScanChosen, choose_search_kernel);
+	return sScanName;
+}
+
+
+// #pragma mark - TextMatcher
+
+
+TextMatcher::TextMatcher()
+	:
+	fAnchorCount(0),
+	fSecondCount(0)
+{
+}
+
+
+TextMatcher::TextMatcher(const char* query)
+	:
+	fAnchorCount(0),
+	fSecondCount(0)
+{
+	SetTo(query);
+}
+
+
+void
+TextMatcher::SetTo(const char* query)
+{
+	// Before the matcher is shared, Matches() may run in many threads
+	std::call_once(sScanChosen, choose_search_kernel);
+
+	size_t length = strlen(query);
+	fold_text(query, length, fFolded);
+
+	fNeedle.clear();
+	const uint8* text = (const uint8*)fFolded.data();
+	const uint8* end = text + fFolded.length();
+	while (text < end)
+		fNeedle.push_back(read_char(text, end));
+
+	fAnchorCount = 0;
+	fSecondCount = 0;
+	if (fNeedle.empty())
+		return;
+
+	std::vector<uint32> variants;
+	case_variants(fNeedle[0], variants);
+	bool singleByte = true;
+	for (size_t i = 0; i < variants.size(); i++) {
+		uint8 lead = lead_byte(variants[i]);
+		singleByte &= variants[i] < 0x80 || (variants[i] & kInvalidByte) != 0;
+
+		bool known = false;
+		for (int32 j = 0; j < fAnchorCount; j++)
+			known |= fAnchors[j] == lead;
+		if (known)
+			continue;
+		if (fAnchorCount == (int32)sizeof(fAnchors)) {
+			fAnchorCount = 0;
+			return;
+		}
+		fAnchors[fAnchorCount++] = lead;
+	}
+
+	// If the first character is always a single byte, the second one
+	// starts right after it and can be checked in the same pass.
+	if (!singleByte || fNeedle.size() < 2)
+		return;
+
+	case_variants(fNeedle[1], variants);
+	if (variants.size() > sizeof(fSeconds))
+		return;
+	for (size_t i = 0; i < variants.size(); i++)
+		fSeconds[fSecondCount++] = lead_byte(variants[i]);
+}
+
+
+bool
+TextMatcher::Matches(const char* text, size_t length) const
+{
+	if (fNeedle.empty())
+		return true;
+
+	search_pattern pattern;
+	pattern.needle = fNeedle.data();
+	pattern.needleLength = fNeedle.size();
+	pattern.anchors = fAnchors;
+	pattern.anchorCount = fAnchorCount;
+	pattern.seconds = fSeconds;
+	pattern.secondCount = fSecondCount;
+
+	return sScan(pattern, (const uint8*)text, length, 0);
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Case-insensitive substring search in UTF-8 text, using Unicode simple
+ * case folding. Candidate positions are found with SSE2/AVX2 where
+ * available (scalar otherwise) and then verified character by character.
+ */
+
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "CoreDefs.h"
+
+
+enum {
+	SEARCH_KERNEL_AUTO = 0,
+	SEARCH_KERNEL_SCALAR,
+	SEARCH_KERNEL_SSE2,
+	SEARCH_KERNEL_AVX2
+};
+
+// Selects the scanning code, by default the fastest one the CPU supports
+// is used. Returns false if the kernel isn't available. Not to be called
+// while other threads are searching.
+bool		set_search_kernel(int32 kernel);
+const char*	search_kernel_name();
+
+// Marks bytes that aren't part of a valid UTF-8 sequence
+static const uint32 kInvalidByte = 0x80000000;
+
+// Simple case folding of a single code point
+uint32		fold_char(uint32 c);
+// Case folds UTF-8 text. Invalid sequences are copied as they are.
+void		fold_text(const char* text, size_t length, std::string& folded);
+
+
+// Decodes the UTF-8 character at 'text' and advances past it. Bytes that
+// don't form a valid sequence are returned one by one as
+// kInvalidByte | byte.
+inline uint32
+read_char(const uint8*& text, const uint8* end)
+{
+	uint8 lead = *text++;
+	if (lead < 0x80)
+		return lead;
+
+	int32 extra;
+	uint32 c;
+	if (lead >= 0xf8 || lead < 0xc0)
+		return kInvalidByte | lead;
+	else if (lead >= 0xf0) {
+		extra = 3;
+		c = lead & 0x07;
+	} else if (lead >= 0xe0) {
+		extra = 2;
+		c = lead & 0x0f;
+	} else {
+		extra = 1;
+		c = lead & 0x1f;
+	}
+
+	if (end - text < extra)
+		return kInvalidByte | lead;
+	for (int32 i = 0; i < extra; i++) {
+		if ((text[i] & 0xc0) != 0x80)
+			return kInvalidByte | lead;
+		c = (c << 6) | (text[i] & 0x3f);
+	}
+	text += extra;
+	return c;
+}
+
+
+class TextMatcher {
+public:
+						TextMatcher();
+						TextMatcher(const char* query);
+
+	void				SetTo(const char* query);
+	bool				IsEmpty() const { return fNeedle.empty(); }
+	// The case folded query
+	const std::string&	Folded() const { return fFolded; }
+
+	bool				Matches(const char* text, size_t length) const;
+	bool				Matches(const std::string& text) const
+							{ return Matches(text.data(), text.length()); }
+
+private:
+	std::string			fFolded;
+	std::vector<uint32>	fNeedle;		// Folded code points
+	// Possible first bytes of a match, as the first character may be
+	// written in different cases.
+	uint8				fAnchors[4];
+	int32				fAnchorCount;
+	// Possible second bytes, only if the first character is always a
+	// single byte
+	uint8				fSeconds[2];
+	int32				fSecondCount;
+};
+
+#endif // TEXTSEARCH_H
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <stdio.h>
+
+#include "Tracing.h"
+
+
+#ifdef CLIPDINGER_TRACE
+
+struct trace_event {
+	const char*			name;
+	uint32				code;
+	int64				start;		// Microseconds
+	int64				duration;
+};
+
+
+struct trace_buffer {
+	// Only contended while exporting
+	std::mutex			lock;
+	int32				thread;
+	const char*			name;
+	bool				used;		// By a live thread
+	int64				count;		// Of all recorded events
+	trace_event			events[kTraceEvents];
+};
+
+
+// Buffers outlive their threads, so their spans can still be exported.
+// The buffer of a thread that ended is taken over by the next new thread,
+// so short lived threads don't pile up buffers.
+static std::vector<trace_buffer*> sBuffers;
+static std::mutex sBufferLock;
+
+
+struct thread_slot {
+	trace_buffer*		buffer;
+
+	~thread_slot()
+	{
+		if (buffer == NULL)
+			return;
+		std::lock_guard<std::mutex> _(sBufferLock);
+		buffer->used = false;
+	}
+};
+
+static thread_local thread_slot tSlot = { NULL };
+
+
+static int64
+trace_time()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+static trace_buffer*
+thread_buffer()
+{
+	if (tSlot.buffer != NULL)
+		return tSlot.buffer;
+
+	std::lock_guard<std::mutex> _(sBufferLock);
+	for (size_t i = 0; i < sBuffers.size(); i++) {
+		trace_buffer* buffer = sBuffers[i];
+		if (!buffer->used) {
+			std::lock_guard<std::mutex> bufferLock(buffer->lock);
+			buffer->used = true;
+			buffer->name = NULL;
+			tSlot.buffer = buffer;
+			return buffer;
+		}
+	}
+
+	trace_buffer* buffer = new trace_buffer;
+	buffer->thread = sBuffers.size() + 1;
+	buffer->name = NULL;
+	buffer->used = true;
+	buffer->count = 0;
+	sBuffers.push_back(buffer);
+	tSlot.buffer = buffer;
+	return buffer;
+}
+
+
+static void
+append_escaped(std::string& json, const char* text)
+{
+	for (; *text != '\0'; text++) {
+		if (*text == '"' || *text == '\\')
+			json += '\\';
+		if ((unsigned char)*text >= 0x20)
+			json += *text;
+	}
+}
+
+
+static void
+append_code(std::string& json, uint32 code)
+{
+	char text[16];
+	bool printable = true;
+	for (int32 shift = 24; shift >= 0; shift -= 8) {
+		char c = (code >> shift) & 0xff;
+		if (c < 0x20 || c > 0x7e)
+			printable = false;
+	}
+	if (printable) {
+		snprintf(text, sizeof(text), " '%c%c%c%c'", (char)(code >> 24),
+			(char)(code >> 16), (char)(code >> 8), (char)code);
+	} else
+		snprintf(text, sizeof(text), " 0x%08x", (unsigned)code);
+	append_escaped(json, text);
+}
+
+
+static void
+record_span(const char* name, uint32 code, int64 start)
+{
+	int64 end = trace_time();
+	trace_buffer* buffer = thread_buffer();
+
+	std::lock_guard<std::mutex> _(buffer->lock);
+	trace_event& event = buffer->events[buffer->count % kTraceEvents];
+	event.name = name;
+	event.code = code;
+	event.start = start;
+	event.duration = end - start;
+	buffer->count++;
+}
+
+
+TraceSpan::TraceSpan(const char* name, uint32 code)
+	:
+	fName(name),
+	fCode(code),
+	fStart(trace_time())
+{
+}
+
+
+TraceSpan::~TraceSpan()
+{
+	record_span(fName, fCode, fStart);
+}
+
+
+bool
+trace_enabled()
+{
+	return true;
+}
+
+
+void
+trace_name_thread(const char* name)
+{
+	trace_buffer* buffer = thread_buffer();
+	std::lock_guard<std::mutex> _(buffer->lock);
+	buffer->name = name;
+}
+
+
+int64
+trace_now()
+{
+	return trace_time();
+}
+
+
+void
+trace_since(const char* name, int64 start)
+{
+	record_span(name, 0, start);
+}
+
+
+std::string
+trace_export()
+{
+	std::string json = "{\"traceEvents\":[";
+	bool first = true;
+	char line[128];
+
+	std::lock_guard<std::mutex> _(sBufferLock);
+	for (size_t i = 0; i < sBuffers.size(); i++) {
+		trace_buffer* buffer = sBuffers[i];
+		std::lock_guard<std::mutex> bufferLock(buffer->lock);
+
+		if (buffer->name != NULL) {
+			json += first ? "\n" : ",\n";
+			first = false;
+			snprintf(line, sizeof(line), "{\"name\":\"thread_name\","
+				"\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"",
+				(int)buffer->thread);
+			json += line;
+			append_escaped(json, buffer->name);
+			json += "\"}}";
+		}
+
+		// The ring holds the newest events, oldest first from 'count'
+		int64 start = buffer->count > kTraceEvents
+			? buffer->count - kTraceEvents : 0;
+		for (int64 j = start; j < buffer->count; j++) {
+			const trace_event& event = buffer->events[j % kTraceEvents];
+			json += first ? "\n" : ",\n";
+			first = false;
+			json += "{\"name\":\"";
+			append_escaped(json, event.name);
+			if (event.code != 0)
+				append_code(json, event.code);
+			snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"ts\":%lld,"
+				"\"dur\":%lld,\"pid\":1,\"tid\":%d}", (long long)event.start,
+				(long long)event.duration, (int)buffer->thread);
+			json += line;
+		}
+	}
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return json;
+}
+
+
+void
+trace_reset()
+{
+	std::lock_guard<std::mutex> _(sBufferLock);
+	for (size_t i = 0; i < sBuffers.size(); i++) {
+		std::lock_guard<std::mutex> bufferLock(sBuffers[i]->lock);
+		sBuffers[i]->count = 0;
+	}
+}
+
+
+#else // !CLIPDINGER_TRACE
+
+
+bool
+trace_enabled()
+{
+	return false;
+}
+
+
+void
+trace_name_thread(const char* /*name*/)
+{
+}
+
+
+int64
+trace_now()
+{
+	return 0;
+}
+
+
+void
+trace_since(const char* /*name*/, int64 /*start*/)
+{
+}
+
+
+std::string
+trace_export()
+{
+	return "{\"traceEvents\":[]}\n";
+}
+
+
+void
+trace_reset()
+{
+}
+
+
+#endif // CLIPDINGER_TRACE
+
+
+status_t
+trace_dump(const char* path)
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+		return B_ERROR;
+
+	std::string json = trace_export();
+	bool written = fwrite(json.data(), 1, json.length(), file)
+		== json.length();
+	if (fclose(file) != 0 || !written)
+		return B_IO_ERROR;
+	return B_OK;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * Opt-in spans that show where the time goes, e.g. at startup or per
+ * message. Built with CLIPDINGER_TRACE defined ("make TRACE=1" in src/ or
+ * headless/), a span records when it started and how long it took into a
+ * ring buffer of its own thread once it ends. The newest kTraceEvents
+ * spans of every thread are kept, recording doesn't allocate once a
+ * thread has its buffer.
+ *
+ * The spans are exported as Chrome trace event JSON, which chrome://tracing
+ * and Perfetto can show as a timeline.
+ *
+ * Without CLIPDINGER_TRACE the macros compile to nothing.
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <string>
+
+#include "CoreDefs.h"
+
+
+static const int32 kTraceEvents = 4096;	// Per thread
+
+
+#ifdef CLIPDINGER_TRACE
+
+class TraceSpan {
+public:
+						TraceSpan(const char* name, uint32 code = 0);
+						~TraceSpan();
+
+private:
+						TraceSpan(const TraceSpan&);
+			TraceSpan& operator=(const TraceSpan&);
+
+	const char*			fName;		// A string literal
+	uint32				fCode;
+	int64				fStart;
+};
+
+#define TRACE_SPAN(name) TraceSpan _traceSpan(name)
+// A span per message code, e.g. "MainWindow::MessageReceived 'fiin'"
+#define TRACE_MESSAGE(name, what) TraceSpan _traceSpan(name, what)
+// Names the calling thread in the timeline, 'name' must be a literal
+#define TRACE_THREAD(name) trace_name_thread(name)
+// A span from 'start', a trace_now() taken earlier, until now. For spans
+// that don't fit a scope, like the startup of a window.
+#define TRACE_SINCE(name, start) trace_since(name, start)
+
+#else
+#define TRACE_SPAN(name)
+#define TRACE_MESSAGE(name, what)
+#define TRACE_THREAD(name)
+#define TRACE_SINCE(name, start)
+#endif // CLIPDINGER_TRACE
+
+
+bool		trace_enabled();
+void		trace_name_thread(const char* name);
+// The clock of the spans, 0 without CLIPDINGER_TRACE
+int64		trace_now();
+void		trace_since(const char* name, int64 start);
+// The spans of all threads as Chrome trace event JSON
+std::string	trace_export();
+status_t	trace_dump(const char* path);
+void		trace_reset();
+
+#endif // TRACING_H
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <stdio.h>
+#include <string.h>
+
+#include "RecordFile.h"
+#include "TextSearch.h"
+#include "TrigramIndex.h"
+
+
+static const uint32 kIndexMagic = 'CDTI';
+static const uint32 kIndexVersion = 2;
+static const uint32 kTrigramSpace = 1 << 24;
+
+
+static inline uint8
+fold(uint8 c)
+{
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+
+static inline uint32
+trigram_at(const uint8* text)
+{
+	return (fold(text[0]) << 16) | (fold(text[1]) << 8) | fold(text[2]);
+}
+
+
+TrigramIndex::TrigramIndex()
+	:
+	fEntries(0),
+	fDeadEntries(0)
+{
+}
+
+
+TrigramIndex::~TrigramIndex()
+{
+}
+
+
+void
+TrigramIndex::Add(uint32 id, const char* text, size_t length)
+{
+	_CollectTrigrams(text, length);
+
+	// Ids are handed out in ascending order, so appending keeps the
+	// posting lists sorted.
+	for (size_t i = 0; i < fTrigrams.size(); i++)
+		fPostings[fTrigrams[i]].push_back(id);
+
+	if (fCounts.size() <= id)
+		fCounts.resize(id + 1, 0);
+	fCounts[id] = fTrigrams.size();
+	fEntries += fTrigrams.size();
+}
+
+
+void
+TrigramIndex::Remove(uint32 id)
+{
+	if (id >= fCounts.size() || fCounts[id] == 0)
+		return;
+
+	// The ids stay in the posting lists until the next compaction
+	fDeadEntries += fCounts[id];
+	fCounts[id] = 0;
+
+	if (fDeadEntries > 4096 && fDeadEntries > fEntries / 2)
+		_Compact();
+}
+
+
+void
+TrigramIndex::MakeEmpty()
+{
+	fPostings.clear();
+	fCounts.clear();
+	fEntries = 0;
+	fDeadEntries = 0;
+}
+
+
+void
+TrigramIndex::Swap(TrigramIndex& other)
+{
+	// The scratch space isn't worth swapping
+	fPostings.swap(other.fPostings);
+	fCounts.swap(other.fCounts);
+	std::swap(fEntries, other.fEntries);
+	std::swap(fDeadEntries, other.fDeadEntries);
+}
+
+
+bool
+TrigramIndex::Find(const char* query, std::vector<uint32>& ids) const
+{
+	ids.clear();
+
+	size_t length = strlen(query);
+	if (length < 3)
+		return false;
+
+	const uint8* text = (const uint8*)query;
+	std::vector<uint32> trigrams;
+	for (size_t i = 0; i + 2 < length; i++)
+		trigrams.push_back(trigram_at(text + i));
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	std::vector<const std::vector<uint32>*> lists;
+	for (size_t i = 0; i < trigrams.size(); i++) {
+		PostingMap::const_iterator found = fPostings.find(trigrams[i]);
+		if (found == fPostings.end())
+			return true;
+		lists.push_back(&found->second);
+	}
+
+	// Start with the shortest list, it limits the result the most
+	std::sort(lists.begin(), lists.end(),
+		[](const std::vector<uint32>* a, const std::vector<uint32>* b) {
+			return a->size() < b->size();
+		});
+
+	for (size_t i = 0; i < lists[0]->size(); i++) {
+		uint32 id = (*lists[0])[i];
+		if (fCounts[id] != 0)
+			ids.push_back(id);
+	}
+
+	std::vector<uint32> intersection;
+	for (size_t i = 1; i < lists.size() && !ids.empty(); i++) {
+		intersection.clear();
+		std::set_intersection(ids.begin(), ids.end(), lists[i]->begin(),
+			lists[i]->end(), std::back_inserter(intersection));
+		ids.swap(intersection);
+	}
+	return true;
+}
+
+
+status_t
+TrigramIndex::Save(const char* path, uint64 signature,
+	const std::unordered_map<uint32, uint32>& saveIds) const
+{
+	std::string buffer;
+	Snapshot(buffer, signature, saveIds);
+	return write_file_atomically(path, buffer.data(), buffer.length());
+}
+
+
+void
+TrigramIndex::Snapshot(std::string& buffer, uint64 signature,
+	const std::unordered_map<uint32, uint32>& saveIds) const
+{
+	uint32 header[2] = { kIndexMagic, kIndexVersion };
+	uint32 count = fPostings.size();
+	buffer.clear();
+	buffer.reserve(sizeof(header) + sizeof(signature) + sizeof(count)
+		+ count * 2 * sizeof(uint32) + fEntries * sizeof(uint32));
+	buffer.append((const char*)header, sizeof(header));
+	buffer.append((const char*)&signature, sizeof(signature));
+	buffer.append((const char*)&count, sizeof(count));
+
+	std::vector<uint32> ids;
+	for (PostingMap::const_iterator it = fPostings.begin();
+			it != fPostings.end(); it++) {
+		ids.clear();
+		for (size_t i = 0; i < it->second.size(); i++) {
+			std::unordered_map<uint32, uint32>::const_iterator found
+				= saveIds.find(it->second[i]);
+			if (found != saveIds.end())
+				ids.push_back(found->second);
+		}
+		std::sort(ids.begin(), ids.end());
+
+		uint32 entry[2] = { it->first, (uint32)ids.size() };
+		buffer.append((const char*)entry, sizeof(entry));
+		if (!ids.empty())
+			buffer.append((const char*)&ids[0], ids.size() * sizeof(uint32));
+	}
+}
+
+
+status_t
+TrigramIndex::Load(const char* path, uint64 signature,
+	const std::vector<uint32>& loadIds)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	uint32 header[2];
+	uint64 savedSignature;
+	uint32 count;
+	if (fread(header, sizeof(header), 1, file) != 1
+		|| fread(&savedSignature, sizeof(savedSignature), 1, file) != 1
+		|| fread(&count, sizeof(count), 1, file) != 1
+		|| header[0] != kIndexMagic || header[1] != kIndexVersion
+		|| savedSignature != signature || count > kTrigramSpace) {
+		fclose(file);
+		return B_BAD_DATA;
+	}
+
+	MakeEmpty();
+
+	status_t status = B_OK;
+	for (uint32 i = 0; i < count; i++) {
+		uint32 entry[2];
+		if (fread(entry, sizeof(entry), 1, file) != 1
+			|| entry[0] >= kTrigramSpace || entry[1] > loadIds.size()) {
+			status = B_BAD_DATA;
+			break;
+		}
+
+		std::vector<uint32>& list = fPostings[entry[0]];
+		list.resize(entry[1]);
+		if (entry[1] > 0
+			&& fread(&list[0], sizeof(uint32), entry[1], file) != entry[1]) {
+			status = B_BAD_DATA;
+			break;
+		}
+
+		for (size_t j = 0; j < list.size(); j++) {
+			if (list[j] >= loadIds.size()) {
+				status = B_BAD_DATA;
+				break;
+			}
+			list[j] = loadIds[list[j]];
+			if (fCounts.size() <= list[j])
+				fCounts.resize(list[j] + 1, 0);
+			fCounts[list[j]]++;
+		}
+		if (status != B_OK)
+			break;
+
+		if (!std::is_sorted(list.begin(), list.end()))
+			std::sort(list.begin(), list.end());
+		fEntries += list.size();
+	}
+	fclose(file);
+
+	if (status != B_OK)
+		MakeEmpty();
+	return status;
+}
+
+
+void
+TrigramIndex::_CollectTrigrams(const char* text, size_t length)
+{
+	fTrigrams.clear();
+	if (length < 3)
+		return;
+
+	// Index the case folded text. Pure ASCII is folded on the fly.
+	for (size_t i = 0; i < length; i++) {
+		if ((uint8)text[i] >= 0x80) {
+			fold_text(text, length, fFolded);
+			text = fFolded.data();
+			length = fFolded.length();
+			break;
+		}
+	}
+
+	if (fSeen.empty())
+		fSeen.resize(kTrigramSpace / 64, 0);
+
+	const uint8* bytes = (const uint8*)text;
+	for (size_t i = 0; i + 2 < length; i++) {
+		uint32 trigram = trigram_at(bytes + i);
+		uint64 bit = 1ULL << (trigram & 63);
+		if ((fSeen[trigram >> 6] & bit) == 0) {
+			fSeen[trigram >> 6] |= bit;
+			fTrigrams.push_back(trigram);
+		}
+	}
+
+	// Only clear what we've set, that's cheaper than clearing it all
+	for (size_t i = 0; i < fTrigrams.size(); i++)
+		fSeen[fTrigrams[i] >> 6] = 0;
+
+	if (fFolded.capacity() > 65536)
+		std::string().swap(fFolded);
+}
+
+
+void
+TrigramIndex::_Compact()
+{
+	for (PostingMap::iterator it = fPostings.begin(); it != fPostings.end();) {
+		std::vector<uint32>& list = it->second;
+		list.erase(std::remove_if(list.begin(), list.end(),
+			[this](uint32 id) { return fCounts[id] == 0; }), list.end());
+
+		if (list.empty())
+			it = fPostings.erase(it);
+		else {
+			list.shrink_to_fit();
+			it++;
+		}
+	}
+	fEntries -= fDeadEntries;
+	fDeadEntries = 0;
+}
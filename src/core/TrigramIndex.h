@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * An inverted index from the byte trigrams of the case folded clips to
+ * the ids of the clips containing them. Intersecting the posting lists of
+ * a query's trigrams gives the candidate clips for a substring search,
+ * which then only have to be verified.
+ */
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <stddef.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CoreDefs.h"
+
+
+class TrigramIndex {
+public:
+						TrigramIndex();
+						~TrigramIndex();
+
+	void				Add(uint32 id, const char* text, size_t length);
+	void				Remove(uint32 id);
+	void				MakeEmpty();
+	void				Swap(TrigramIndex& other);
+
+	// Ids of all clips containing every trigram of the (case folded) query,
+	// in ascending order. Returns false if the query is too short to use
+	// the index.
+	bool				Find(const char* query,
+							std::vector<uint32>& ids) const;
+
+	int32				CountTrigrams() const { return fPostings.size(); }
+	size_t				CountEntries() const { return fEntries; }
+
+	// The ids are written as mapped by 'saveIds', ids missing in there are
+	// dropped. When loading, 'loadIds' maps the saved ids to the live ones.
+	// The signature must match the one used for saving. Save() replaces
+	// the file atomically, see write_file_atomically().
+	status_t			Save(const char* path, uint64 signature,
+							const std::unordered_map<uint32, uint32>& saveIds)
+							const;
+	// What Save() writes, e.g. to hand it to a FileWriter
+	void				Snapshot(std::string& buffer, uint64 signature,
+							const std::unordered_map<uint32, uint32>& saveIds)
+							const;
+	status_t			Load(const char* path, uint64 signature,
+							const std::vector<uint32>& loadIds);
+
+private:
+	typedef std::unordered_map<uint32, std::vector<uint32> > PostingMap;
+
+	void				_CollectTrigrams(const char* text, size_t length);
+	void				_Compact();
+
+	PostingMap			fPostings;
+	// Number of trigrams of every live id, 0 if removed
+	std::vector<uint32>	fCounts;
+	size_t				fEntries;
+	size_t				fDeadEntries;
+
+	// Scratch space to find the distinct trigrams of a text
+	std::vector<uint64>	fSeen;
+	std::vector<uint32>	fTrigrams;
+	std::string			fFolded;
+};
+
+#endif // TRIGRAMINDEX_H
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ */
+
+#include "VisibleRows.h"
+
+
+VisibleRows::VisibleRows(int32 overscan)
+	:
+	fOverscan(overscan),
+	fRowHeight(1),
+	fCount(0)
+{
+}
+
+
+void
+VisibleRows::SetRowHeight(float height)
+{
+	fRowHeight = height >= 1 ? height : 1;
+}
+
+
+int32
+VisibleRows::RowAt(float y) const
+{
+	if (y < 0)
+		return -1;
+
+	int32 row = (int32)(y / fRowHeight);
+	return row < fCount ? row : -1;
+}
+
+
+bool
+VisibleRows::RowsIn(float top, float bottom, int32& first, int32& last) const
+{
+	if (fCount == 0 || bottom < top || bottom < 0 || top >= Height())
+		return false;
+
+	first = top > 0 ? (int32)(top / fRowHeight) : 0;
+	last = (int32)(bottom / fRowHeight);
+	if (last >= fCount)
+		last = fCount - 1;
+	return first <= last;
+}
+
+
+bool
+VisibleRows::RowsAround(float top, float bottom, int32& first,
+	int32& last) const
+{
+	if (!RowsIn(top, bottom, first, last))
+		return false;
+
+	first = first > fOverscan ? first - fOverscan : 0;
+	last = last < fCount - 1 - fOverscan ? last + fOverscan : fCount - 1;
+	return true;
+}
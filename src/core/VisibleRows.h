@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026. All rights reserved.
+ * Distributed under the terms of the MIT license.
+ *
+ * The rows of a list that are in view. All rows have the same height, so
+ * they're worked out from the scroll position alone, however many there
+ * are. The display state of those rows is kept in a RowCache, the other
+ * rows have none.
+ */
+
+#ifndef VISIBLEROWS_H
+#define VISIBLEROWS_H
+
+#include <unordered_map>
+
+#include <stddef.h>
+
+#include "CoreDefs.h"
+
+
+class VisibleRows {
+public:
+						// 'overscan' rows above and below the visible
+						// ones are kept too, for scrolling a bit
+						VisibleRows(int32 overscan);
+
+	void				SetRowHeight(float height);
+	float				RowHeight() const { return fRowHeight; }
+	void				SetCount(int32 count) { fCount = count; }
+	int32				CountRows() const { return fCount; }
+	float				Height() const { return fCount * fRowHeight; }
+
+	// -1 if there's no row at 'y'
+	int32				RowAt(float y) const;
+	float				RowTop(int32 row) const { return row * fRowHeight; }
+	float				RowBottom(int32 row) const
+							{ return (row + 1) * fRowHeight - 1; }
+
+	// The rows between 'top' and 'bottom', false if there are none
+	bool				RowsIn(float top, float bottom, int32& first,
+							int32& last) const;
+	// The same plus the overscan, these are worth keeping
+	bool				RowsAround(float top, float bottom, int32& first,
+							int32& last) const;
+
+private:
+	int32				fOverscan;
+	float				fRowHeight;
+	int32				fCount;
+};
+
+
+// Display state per row, by a key that stays with the row when rows are
+// added or removed above it. After scrolling, Retain() the rows that are
+// around and Trim() drops the others.
+template<typename Key, typename Item>
+class RowCache {
+public:
+						RowCache() : fMark(0) {}
+						~RowCache() { MakeEmpty(); }
+
+	// NULL if there's none yet
+	Item*				Get(const Key& key) const
+							{
+								typename Map::const_iterator found
+									= fItems.find(key);
+								return found != fItems.end()
+									? found->second.item : NULL;
+							}
+	void				Put(const Key& key, Item* item)
+							{
+								Remove(key);
+								entry& added = fItems[key];
+								added.item = item;
+								added.mark = fMark;
+							}
+	void				Remove(const Key& key)
+							{
+								typename Map::iterator found
+									= fItems.find(key);
+								if (found == fItems.end())
+									return;
+								delete found->second.item;
+								fItems.erase(found);
+							}
+
+	void				Retain(const Key& key)
+							{
+								typename Map::iterator found
+									= fItems.find(key);
+								if (found != fItems.end())
+									found->second.mark = fMark;
+							}
+	// Deletes the items that weren't retained or put since the last time
+	void				Trim()
+							{
+								typename Map::iterator it = fItems.begin();
+								while (it != fItems.end()) {
+									if (it->second.mark != fMark) {
+										delete it->second.item;
+										it = fItems.erase(it);
+									} else
+										++it;
+								}
+								fMark++;
+							}
+
+	int32				CountItems() const { return fItems.size(); }
+	template<typename Function>
+	void				ForEach(Function function)
+							{
+								typename Map::iterator it = fItems.begin();
+								for (; it != fItems.end(); ++it)
+									function(it->first, it->second.item);
+							}
+	void				MakeEmpty()
+							{
+								typename Map::iterator it = fItems.begin();
+								for (; it != fItems.end(); ++it)
+									delete it->second.item;
+								fItems.clear();
+							}
+
+private:
+	struct entry {
+		Item*			item;
+		uint32			mark;
+	};
+	typedef std::unordered_map<Key, entry> Map;
+
+						RowCache(const RowCache&);
+			RowCache&	operator=(const RowCache&);
+
+	Map					fItems;
+	uint32				fMark;
+};
+
+#endif // VISIBLEROWS_H